@@ -57,6 +57,11 @@ class SaberCentralBlockBase : public util::Printable, private boost::noncopyable
   // Block randomization
   virtual void multiply(oops::FieldSet3D &) const = 0;
 
+  // Block multiplication for a batch of FieldSets (e.g. localized ensemble members), to be
+  // overridden by blocks that can apply their operator to all the batch in one pass
+  virtual void multiplyBatch(std::vector<oops::FieldSet3D> & fsets) const
+    {for (auto & fset : fsets) this->multiply(fset);}
+
   // Setup / calibration methods
 
   // Read block data
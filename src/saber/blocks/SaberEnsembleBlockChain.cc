@@ -7,14 +7,173 @@
 
 #include "saber/blocks/SaberEnsembleBlockChain.h"
 
+#include <algorithm>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "atlas/array.h"
+#include "atlas/field.h"
+#include "atlas/functionspace.h"
+#include "atlas/parallel/omp/omp.h"
+
+#include "oops/util/Timer.h"
+
 #include "saber/oops/Utilities.h"
 
 namespace saber {
 
+namespace {
+
+// -----------------------------------------------------------------------------
+
+/// Check that a work FieldSet has the same fields as a reference FieldSet.
+bool sameFields(const atlas::FieldSet & work, const atlas::FieldSet & ref) {
+  if (work.size() != ref.size()) return false;
+  for (const auto & field : ref) {
+    if (!work.has(field.name()) || work[field.name()].size() != field.size()) return false;
+  }
+  return true;
+}
+
+// -----------------------------------------------------------------------------
+
+/// Copy x into a persistent work FieldSet, allocated only if its fields do not match.
+void copyInto(const oops::FieldSet3D & x, oops::FieldSet3D & work) {
+  if (!sameFields(work.fieldSet(), x.fieldSet())) {
+    work.fieldSet() = atlas::FieldSet();
+    work.deepCopy(x.fieldSet());
+    return;
+  }
+  for (const auto & field : x.fieldSet()) {
+    const double * xPtr = field.array().data<double>();
+    double * wPtr = work.fieldSet()[field.name()].array().data<double>();
+    atlas_omp_parallel_for(atlas::idx_t jj = 0; jj < field.size(); ++jj) {
+      wPtr[jj] = xPtr[jj];
+    }
+  }
+}
+
+// -----------------------------------------------------------------------------
+
+/// Schur product of x by an ensemble member into a persistent work FieldSet.
+void schurProductInto(const oops::FieldSet3D & x,
+                      const oops::FieldSet3D & ens,
+                      oops::FieldSet3D & work) {
+  copyInto(x, work);
+  for (auto & field : work.fieldSet()) {
+    if (ens.fieldSet().has(field.name())) {
+      const double * ePtr = ens.fieldSet()[field.name()].array().data<double>();
+      double * wPtr = field.array().data<double>();
+      atlas_omp_parallel_for(atlas::idx_t jj = 0; jj < field.size(); ++jj) {
+        wPtr[jj] *= ePtr[jj];
+      }
+    }
+  }
+}
+
+// -----------------------------------------------------------------------------
+
+/// Accumulate the Schur product of a work FieldSet by an ensemble member.
+void accumulateSchurProduct(const oops::FieldSet3D & work,
+                            const oops::FieldSet3D & ens,
+                            oops::FieldSet3D & out) {
+  for (auto & field : out.fieldSet()) {
+    if (!work.fieldSet().has(field.name())) continue;
+    const double * wPtr = work.fieldSet()[field.name()].array().data<double>();
+    double * oPtr = field.array().data<double>();
+    if (ens.fieldSet().has(field.name())) {
+      const double * ePtr = ens.fieldSet()[field.name()].array().data<double>();
+      atlas_omp_parallel_for(atlas::idx_t jj = 0; jj < field.size(); ++jj) {
+        oPtr[jj] += wPtr[jj]*ePtr[jj];
+      }
+    } else {
+      atlas_omp_parallel_for(atlas::idx_t jj = 0; jj < field.size(); ++jj) {
+        oPtr[jj] += wPtr[jj];
+      }
+    }
+  }
+}
+
+// -----------------------------------------------------------------------------
+
+/// Allocate zero fields with the layout of a reference FieldSet, without copying its values.
+void zeroLike(const oops::FieldSet3D & ref, oops::FieldSet3D & out) {
+  atlas::FieldSet fset;
+  for (const auto & field : ref.fieldSet()) {
+    atlas::Field fld = field.functionspace().createField<double>(
+      atlas::option::name(field.name()) | atlas::option::levels(field.levels()));
+    fld.metadata() = field.metadata();
+    atlas::array::make_view<double, 2>(fld).assign(0.0);
+    fld.set_dirty(false);
+    fset.add(fld);
+  }
+  out.fieldSet() = fset;
+}
+
+// -----------------------------------------------------------------------------
+
+/// Variable and level layout of a FieldSet4D.
+std::string layoutKey(const oops::FieldSet4D & fset4d) {
+  std::string key = std::to_string(fset4d.size());
+  for (const auto & field : fset4d[0].fieldSet()) {
+    key += ";" + field.name() + ":" + std::to_string(field.levels());
+  }
+  return key;
+}
+
+// -----------------------------------------------------------------------------
+
+/// Accumulate a weighted ensemble member.
+void accumulateWeighted(const oops::FieldSet3D & ens,
+                        const double & wgt,
+                        oops::FieldSet3D & out) {
+  for (auto & field : out.fieldSet()) {
+    if (!ens.fieldSet().has(field.name())) continue;
+    const double * ePtr = ens.fieldSet()[field.name()].array().data<double>();
+    double * oPtr = field.array().data<double>();
+    atlas_omp_parallel_for(atlas::idx_t jj = 0; jj < field.size(); ++jj) {
+      oPtr[jj] += ePtr[jj]*wgt;
+    }
+  }
+}
+
+// -----------------------------------------------------------------------------
+
+}  // namespace
+
+// -----------------------------------------------------------------------------
+
+oops::FieldSet4D & SaberEnsembleBlockChain::workBuffer(const oops::FieldSet4D & fset4d,
+                                                       const size_t & jb) const {
+  // Work buffers persist across applications, their fields are allocated on first use
+  if (workBuffers_.size() <= jb) {
+    workBuffers_.resize(jb+1);
+  }
+  if (!workBuffers_[jb] || workBuffers_[jb]->times() != fset4d.times()) {
+    workBuffers_[jb] = std::make_unique<oops::FieldSet4D>(fset4d.times(), fset4d.commTime(),
+                                                          fset4d[0].commGeom());
+  }
+  return *workBuffers_[jb];
+}
+
+// -----------------------------------------------------------------------------
+
+oops::FieldSet4D & SaberEnsembleBlockChain::inputBuffer(const oops::FieldSet4D & fset4d) const {
+  // One persistent copy per variable and level layout, its fields are allocated on first use
+  std::unique_ptr<oops::FieldSet4D> & buffer = inputBuffers_[layoutKey(fset4d)];
+  if (!buffer || buffer->times() != fset4d.times()) {
+    buffer = std::make_unique<oops::FieldSet4D>(fset4d.times(), fset4d.commTime(),
+                                                fset4d[0].commGeom());
+  }
+  return *buffer;
+}
+
 // -----------------------------------------------------------------------------
 
 void SaberEnsembleBlockChain::multiply(oops::FieldSet4D & fset4d) const {
   oops::Log::trace() << "saber::generic::SaberEnsembleBlockChain::multiply starting" << std::endl;
+  util::Timer timer("saber::generic::SaberEnsembleBlockChain", "multiply");
 
   // Outer blocks adjoint multiplication
   if (outerBlockChain_) {
@@ -23,41 +182,47 @@ void SaberEnsembleBlockChain::multiply(oops::FieldSet4D & fset4d) const {
 
   // Central block: ensemble covariance
   // Initialization
-  const oops::FieldSet4D fset4dInit = oops::copyFieldSet4D(fset4d);
+  oops::FieldSet4D & fset4dInit = workBuffer(fset4d, 0);
+  for (size_t it = 0; it < fset4d.size(); ++it) {
+    copyInto(fset4d[it], fset4dInit[it]);
+  }
   fset4d.zero();
-  for (size_t ie = 0; ie < ensemble_.ens_size(); ++ie) {
-    // Copy initial FieldSet4D
-    oops::FieldSet4D fset4dMem = oops::copyFieldSet4D(fset4dInit);
-
-    if (locBlockChain_) {
-      // With localization
-      // First schur product
-      for (size_t it = 0; it < fset4dMem.size(); ++it) {
-        fset4dMem[it] *= ensemble_(it, ie);
+  if (locBlockChain_) {
+    // With localization, applied to batches of members
+    for (size_t ie0 = 0; ie0 < ensemble_.local_ens_size(); ie0 += locBatchSize_) {
+      const size_t ie1 = std::min(ie0+locBatchSize_, ensemble_.local_ens_size());
+      std::vector<oops::FieldSet4D *> fset4dMems;
+      for (size_t ie = ie0; ie < ie1; ++ie) {
+        fset4dMems.push_back(&workBuffer(fset4d, 1+ie-ie0));
+        // First schur product
+        for (size_t it = 0; it < fset4d.size(); ++it) {
+          schurProductInto(fset4dInit[it], ensemble_(it, ie), (*fset4dMems.back())[it]);
+        }
       }
       // Apply localization
-      locBlockChain_->multiply(fset4dMem);
-      // Second schur product
-      for (size_t it = 0; it < fset4dMem.size(); ++it) {
-        fset4dMem[it] *= ensemble_(it, ie);
+      locBlockChain_->multiply(fset4dMems);
+      for (size_t ie = ie0; ie < ie1; ++ie) {
+        // Second schur product and member contribution
+        for (size_t it = 0; it < fset4d.size(); ++it) {
+          accumulateSchurProduct((*fset4dMems[ie-ie0])[it], ensemble_(it, ie), fset4d[it]);
+        }
       }
-      // Add up member contribution
-      fset4d += fset4dMem;
-    } else {
+    }
+  } else {
+    for (size_t ie = 0; ie < ensemble_.local_ens_size(); ++ie) {
       // No localization
       // Compute weight
       const double wgt = fset4dInit.dot_product_with(ensemble_, ie, vars_);
-      // Copy ensemble member
-      fset4dMem.deepCopy(ensemble_, ie);
-      // Apply weight
-      fset4dMem *= wgt;
-      // Add up member contribution
-      fset4d += fset4dMem;
+      // Add up weighted member
+      for (size_t it = 0; it < fset4d.size(); ++it) {
+        accumulateWeighted(ensemble_(it, ie), wgt, fset4d[it]);
+      }
     }
-    // TODO(Algo): Add communication here when the code starts supporting
-    // ensemble members distributed across MPI tasks.
   }
 
+  // Add up contributions of members on other tasks
+  allReduceMembers(fset4d);
+
   // Normalize result
   const double rk = 1.0/static_cast<double>(ensemble_.ens_size()-1);
   fset4d *= rk;
@@ -74,26 +239,22 @@ void SaberEnsembleBlockChain::multiply(oops::FieldSet4D & fset4d) const {
 
 void SaberEnsembleBlockChain::randomize(oops::FieldSet4D & fset4d) const {
   // Central block: randomization with ensemble covariance
-  fset4d.deepCopy(ensemble_, 0);
-  fset4d.zero();
+  for (size_t it = 0; it < fset4d.size(); ++it) {
+    zeroLike(ensemble_(it, 0), fset4d[it]);
+  }
   std::unique_ptr<util::NormalDistribution<double>> normalDist;
 
-  for (unsigned int ie = 0; ie < ensemble_.ens_size(); ++ie) {
-    // Create empty FieldSet4D
-    oops::FieldSet4D fset4dMem(fset4d.times(), fset4d.commTime(), fset4d[0].commGeom());
-
-    // Copy ensemble member
-    fset4dMem.deepCopy(ensemble_, ie);
-
+  for (size_t ie = 0; ie < ensemble_.local_ens_size(); ++ie) {
     if (locBlockChain_) {
       // With localization
 
       // Randomize localization
+      oops::FieldSet4D & fset4dMem = workBuffer(fset4d, 1);
       locBlockChain_->randomize(fset4dMem);
 
-      // Schur product
-      for (size_t it = 0; it < fset4dMem.size(); ++it) {
-        fset4dMem[it] *= ensemble_(it, ie);
+      // Schur product and member contribution
+      for (size_t it = 0; it < fset4d.size(); ++it) {
+        accumulateSchurProduct(fset4dMem[it], ensemble_(it, ie), fset4d[it]);
       }
     } else {
       // No localization
@@ -102,14 +263,16 @@ void SaberEnsembleBlockChain::randomize(oops::FieldSet4D & fset4d) const {
           seed_));
       }
 
-      // Apply weight
-      fset4dMem *= (*normalDist)[ie];
+      // Add up weighted member
+      for (size_t it = 0; it < fset4d.size(); ++it) {
+        accumulateWeighted(ensemble_(it, ie), (*normalDist)[firstMember_+ie], fset4d[it]);
+      }
     }
-
-    // Add up member contribution
-    fset4d += fset4dMem;
   }
 
+  // Add up contributions of members on other tasks
+  allReduceMembers(fset4d);
+
   // Normalize result
   const double rk = 1.0/sqrt(static_cast<double>(ensemble_.ens_size()-1));
   fset4d *= rk;
@@ -127,39 +290,39 @@ void SaberEnsembleBlockChain::multiplySqrt(const atlas::Field & cv,
                                            const size_t & offset) const {
   oops::Log::trace() << "saber::generic::SaberEnsembleBlockChain::multiplySqrt starting"
                      << std::endl;
+  util::Timer timer("saber::generic::SaberEnsembleBlockChain", "multiplySqrt");
 
   // Initialization
   fset4d.zero();
-  size_t index = offset;
+  size_t index = offset+firstMember_*(locBlockChain_ ? locBlockChain_->ctlVecSize() : 1);
 
   // Central block: ensemble covariance square-root
-  for (unsigned int ie = 0; ie < ensemble_.ens_size(); ++ie) {
-    // Create empty FieldSet4D
-    oops::FieldSet4D fset4dMem(fset4d.times(), fset4d.commTime(), fset4d[0].commGeom());
-
+  for (size_t ie = 0; ie < ensemble_.local_ens_size(); ++ie) {
     if (locBlockChain_) {
       // With localization
+      oops::FieldSet4D & fset4dMem = workBuffer(fset4d, 1);
       locBlockChain_->multiplySqrt(cv, fset4dMem, index);
       index += locBlockChain_->ctlVecSize();
 
-      // Schur product
-      for (size_t it = 0; it < fset4dMem.size(); ++it) {
-        fset4dMem[it] *= ensemble_(it, ie);
+      // Schur product and member contribution
+      for (size_t it = 0; it < fset4d.size(); ++it) {
+        accumulateSchurProduct(fset4dMem[it], ensemble_(it, ie), fset4d[it]);
       }
     } else {
       // No localization
       const auto cvView = atlas::array::make_view<double, 1>(cv);
-      fset4dMem.deepCopy(ensemble_, ie);
 
-      // Apply weight
-      fset4dMem *= cvView(index);
+      // Add up weighted member
+      for (size_t it = 0; it < fset4d.size(); ++it) {
+        accumulateWeighted(ensemble_(it, ie), cvView(index), fset4d[it]);
+      }
       ++index;
     }
-
-    // Add up member contribution
-    fset4d += fset4dMem;
   }
 
+  // Add up contributions of members on other tasks
+  allReduceMembers(fset4d);
+
   // Normalize result
   const double rk = 1.0/std::sqrt(static_cast<double>(ensemble_.ens_size()-1));
   fset4d *= rk;
@@ -180,9 +343,20 @@ void SaberEnsembleBlockChain::multiplySqrtAD(const oops::FieldSet4D & fset4d,
                                              const size_t & offset) const {
   oops::Log::trace() << "saber::generic::SaberEnsembleBlockChain::multiplySqrtAD starting"
                      << std::endl;
-
-  // Copy input FieldSet
-  oops::FieldSet4D fset4dInit = oops::copyFieldSet4D(fset4d);
+  util::Timer timer("saber::generic::SaberEnsembleBlockChain", "multiplySqrtAD");
+
+  // Copy input FieldSet into the buffer of its layout. The outer blocks are applied to new
+  // FieldSets sharing these fields, so that the buffer keeps the input layout across calls.
+  oops::FieldSet4D & fset4dCopy = inputBuffer(fset4d);
+  oops::FieldSet4D fset4dInit(fset4d.times(), fset4d.commTime(), fset4d[0].commGeom());
+  for (size_t it = 0; it < fset4d.size(); ++it) {
+    copyInto(fset4d[it], fset4dCopy[it]);
+    atlas::FieldSet fset;
+    for (const auto & field : fset4dCopy[it].fieldSet()) {
+      fset.add(field);
+    }
+    fset4dInit[it].fieldSet() = fset;
+  }
 
   // Outer blocks adjoint multiplication
   if (outerBlockChain_) {
@@ -193,20 +367,27 @@ void SaberEnsembleBlockChain::multiplySqrtAD(const oops::FieldSet4D & fset4d,
   const double rk = 1.0/std::sqrt(static_cast<double>(ensemble_.ens_size()-1));
   fset4dInit *= rk;
 
+  // Control vector entries of members on other tasks are filled by these tasks
+  const eckit::mpi::Comm & commEns = ensemble_.commEns();
+  auto cvView = atlas::array::make_view<double, 1>(cv);
+  if (commEns.size() > 1) {
+    for (size_t jj = offset; jj < offset+ctlVecSize_; ++jj) {
+      cvView(jj) = 0.0;
+    }
+  }
+
   // Initialization
-  size_t index = offset;
+  size_t index = offset+firstMember_*(locBlockChain_ ? locBlockChain_->ctlVecSize() : 1);
 
   // Central block: ensemble covariance square-root adjoint
-  for (unsigned int ie = 0; ie < ensemble_.ens_size(); ++ie) {
+  for (size_t ie = 0; ie < ensemble_.local_ens_size(); ++ie) {
     if (locBlockChain_) {
       // Apply localization
 
-      // Copy initial fieldset
-      oops::FieldSet4D fset4dMem = oops::copyFieldSet4D(fset4dInit);
-
       // First schur product
-      for (size_t it = 0; it < fset4dMem.size(); ++it) {
-        fset4dMem[it] *= ensemble_(it, ie);
+      oops::FieldSet4D & fset4dMem = workBuffer(fset4d, 1);
+      for (size_t it = 0; it < fset4d.size(); ++it) {
+        schurProductInto(fset4dInit[it], ensemble_(it, ie), fset4dMem[it]);
       }
 
       // Apply localization square-root adjoint
@@ -214,18 +395,41 @@ void SaberEnsembleBlockChain::multiplySqrtAD(const oops::FieldSet4D & fset4d,
       index += locBlockChain_->ctlVecSize();
     } else {
       // No localization
-      auto cvView = atlas::array::make_view<double, 1>(cv);
-
       // Compute weight
       cvView(index) = fset4dInit.dot_product_with(ensemble_, ie, vars_);
       ++index;
     }
   }
 
+  // Gather control vector entries of all members
+  if (commEns.size() > 1) {
+    commEns.allReduceInPlace(cvView.data()+offset, ctlVecSize_, eckit::mpi::sum());
+  }
+
   oops::Log::trace() << "saber::generic::SaberEnsembleBlockChain::multiplySqrtAD done"
                      << std::endl;
 }
 
 // -----------------------------------------------------------------------------
 
+void SaberEnsembleBlockChain::allReduceMembers(oops::FieldSet4D & fset4d) const {
+  oops::Log::trace() << "saber::generic::SaberEnsembleBlockChain::allReduceMembers starting"
+                     << std::endl;
+
+  const eckit::mpi::Comm & commEns = ensemble_.commEns();
+  if (commEns.size() > 1) {
+    // Sum over the ensemble communicator, field by field
+    for (size_t it = 0; it < fset4d.size(); ++it) {
+      for (auto & field : fset4d[it].fieldSet()) {
+        commEns.allReduceInPlace(field.array().data<double>(), field.size(), eckit::mpi::sum());
+      }
+    }
+  }
+
+  oops::Log::trace() << "saber::generic::SaberEnsembleBlockChain::allReduceMembers done"
+                     << std::endl;
+}
+
+// -----------------------------------------------------------------------------
+
 }  // namespace saber
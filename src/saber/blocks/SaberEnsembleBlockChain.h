@@ -7,13 +7,17 @@
 
 #pragma once
 
+#include <map>
 #include <memory>
+#include <numeric>
+#include <string>
 #include <utility>
 #include <vector>
 
 #include "atlas/field.h"
 
 #include "eckit/exception/Exceptions.h"
+#include "eckit/mpi/Comm.h"
 
 #include "oops/base/FieldSet4D.h"
 #include "oops/base/FieldSets.h"
@@ -64,6 +68,15 @@ class SaberEnsembleBlockChain : public SaberBlockChainBase {
   const oops::Variables & outerVariables() const {return outerVariables_;}
 
  private:
+  /// @brief Sum the member contributions over the ensemble communicator.
+  void allReduceMembers(oops::FieldSet4D &) const;
+  /// @brief Persistent work buffer (0 for the input increment, 1 to the localization batch
+  ///        size for the members), allocated on first use.
+  oops::FieldSet4D & workBuffer(const oops::FieldSet4D &, const size_t &) const;
+  /// @brief Persistent copy of a square-root adjoint input, keyed on its variable and level
+  ///        layout, allocated on first use.
+  oops::FieldSet4D & inputBuffer(const oops::FieldSet4D &) const;
+
   /// @brief Outer function space
   const atlas::FunctionSpace outerFunctionSpace_;
   /// @brief Outer variables
@@ -72,14 +85,22 @@ class SaberEnsembleBlockChain : public SaberBlockChainBase {
   std::unique_ptr<SaberOuterBlockChain> outerBlockChain_;
   /// @brief Localization block chain (optional).
   std::unique_ptr<SaberParametricBlockChain> locBlockChain_;
+  /// @brief Number of members localized together.
+  size_t locBatchSize_;
   /// @brief Ensemble used in the ensemble covariance.
   oops::FieldSets ensemble_;
+  /// @brief Global index of the first local ensemble member.
+  size_t firstMember_;
   /// @brief Control vector size.
   size_t ctlVecSize_;
   /// @brief Variables used in the ensemble covariance.
   /// TODO(AS): check whether this is needed or can be inferred from ensemble.
   oops::Variables vars_;
   int seed_ = 7;  // For reproducibility
+  /// @brief Work buffers reused across applications.
+  mutable std::vector<std::unique_ptr<oops::FieldSet4D>> workBuffers_;
+  /// @brief Square-root adjoint input copies, by variable and level layout.
+  mutable std::map<std::string, std::unique_ptr<oops::FieldSet4D>> inputBuffers_;
 };
 
 // -----------------------------------------------------------------------------
@@ -99,7 +120,7 @@ SaberEnsembleBlockChain::SaberEnsembleBlockChain(const oops::Geometry<MODEL> & g
                        const eckit::LocalConfiguration & covarConf,
                        const eckit::Configuration & conf)
   : outerFunctionSpace_(geom.functionSpace()), outerVariables_(outerVars),
-    ensemble_(fsetEns), ctlVecSize_(0) {
+    locBatchSize_(1), ensemble_(fsetEns), firstMember_(0), ctlVecSize_(0) {
   oops::Log::trace() << "SaberEnsembleBlockChain ctor starting" << std::endl;
 
   // Check that there is an ensemble of at least 2 members.
@@ -107,6 +128,16 @@ SaberEnsembleBlockChain::SaberEnsembleBlockChain(const oops::Geometry<MODEL> & g
     throw eckit::BadParameter("Ensemble for SaberEnsembleBlockChain has to have at least"
                               " two members.", Here());
   }
+
+  // Ensemble members distribution across the ensemble communicator
+  const eckit::mpi::Comm & commEns = ensemble_.commEns();
+  std::vector<size_t> localEnsSizes(commEns.size());
+  commEns.allGather(ensemble_.local_ens_size(), localEnsSizes.begin(), localEnsSizes.end());
+  for (size_t jt = 0; jt < commEns.rank(); ++jt) {
+    firstMember_ += localEnsSizes[jt];
+  }
+  ASSERT(std::accumulate(localEnsSizes.begin(), localEnsSizes.end(), size_t(0))
+         == ensemble_.ens_size());
   // Create outer blocks if needed
   if (conf.has("saber outer blocks")) {
     std::vector<SaberOuterBlockParametersWrapper> cmpOuterBlocksParams;
@@ -161,6 +192,10 @@ SaberEnsembleBlockChain::SaberEnsembleBlockChain(const oops::Geometry<MODEL> & g
   // Read inflation field
   eckit::LocalConfiguration centralBlockConf = conf.getSubConfiguration("saber central block");
   const double inflationValue = centralBlockConf.getDouble("inflation value", 1);
+  locBatchSize_ = centralBlockConf.getUnsigned("localization batch size", 1);
+  if (locBatchSize_ == 0) {
+    throw eckit::UserError("Localization batch size should be positive", Here());
+  }
   oops::Log::info() << "Info     : Read inflation field" << std::endl;
   oops::FieldSet3D inflationField(fset4dXb[0].validTime(), geom.getComm());
   // Read ATLAS inflation file
@@ -14,6 +14,10 @@
 
 #include <boost/noncopyable.hpp>
 
+#include "atlas/array.h"
+#include "atlas/field.h"
+#include "atlas/functionspace.h"
+
 #include "eckit/exception/Exceptions.h"
 
 #include "oops/base/GeometryData.h"
@@ -244,4 +248,30 @@ void SaberOuterBlockBase::inverseTest(const oops::GeometryData & innerGeometryDa
 
 // -----------------------------------------------------------------------------
 
+atlas::Field SaberOuterBlockBase::pooledField(const atlas::FunctionSpace & fspace,
+                                              const atlas::util::Config & options) const {
+  const std::string name = options.getString("name");
+  const int levels = options.getInt("levels");
+  for (auto & field : fieldPool_) {
+    if (field.get()->owners() == 1 && field.name() == name && field.levels() == levels
+      && field.functionspace().get() == fspace.get()) {
+      // Reuse pooled field
+      atlas::array::make_view<double, 2>(field).assign(0.0);
+      field.set_dirty(false);
+      ++fieldReuses_;
+      return field;
+    }
+  }
+
+  // Allocate new field
+  atlas::Field field = fspace.createField<double>(options);
+  atlas::array::make_view<double, 2>(field).assign(0.0);
+  field.set_dirty(false);
+  fieldPool_.push_back(field);
+  ++fieldAllocations_;
+  return field;
+}
+
+// -----------------------------------------------------------------------------
+
 }  // namespace saber
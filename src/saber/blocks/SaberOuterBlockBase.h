@@ -15,8 +15,13 @@
 
 #include <boost/noncopyable.hpp>
 
+#include "atlas/field.h"
+#include "atlas/functionspace.h"
+#include "atlas/util/Config.h"
+
 #include "eckit/exception/Exceptions.h"
 
+#include "oops/base/FieldSet3D.h"
 #include "oops/base/FieldSets.h"
 #include "oops/base/Geometry.h"
 #include "oops/base/GeometryData.h"
@@ -48,7 +53,7 @@ class SaberOuterBlockBase : public util::Printable, private boost::noncopyable {
   explicit SaberOuterBlockBase(const SaberBlockParametersBase & params,
                                const util::DateTime & validTime)
     : validTime_(validTime), blockName_(params.saberBlockName), skipInverse_(params.skipInverse),
-      filterMode_(params.filterMode) {}
+      filterMode_(params.filterMode), fieldAllocations_(0), fieldReuses_(0) {}
   virtual ~SaberOuterBlockBase() {}
 
   // Accessor
@@ -67,6 +72,15 @@ class SaberOuterBlockBase : public util::Printable, private boost::noncopyable {
   // Block multiplication adjoint
   virtual void multiplyAD(oops::FieldSet3D &) const = 0;
 
+  // Block multiplication for a batch of FieldSets (e.g. localized ensemble members), to be
+  // overridden by blocks that can apply their operator to all the batch in one pass
+  virtual void multiplyBatch(std::vector<oops::FieldSet3D> & fsets) const
+    {for (auto & fset : fsets) this->multiply(fset);}
+
+  // Block multiplication adjoint for a batch of FieldSets
+  virtual void multiplyADBatch(std::vector<oops::FieldSet3D> & fsets) const
+    {for (auto & fset : fsets) this->multiplyAD(fset);}
+
   // Block left inverse multiplication
   virtual void leftInverseMultiply(oops::FieldSet3D &) const
     {throw eckit::NotImplemented("leftInverseMultiply not implemented yet for the block "
@@ -99,6 +113,10 @@ class SaberOuterBlockBase : public util::Printable, private boost::noncopyable {
     {throw eckit::NotImplemented("iterativeCalibrationUpdate not implemented yet for the block "
       + this->blockName(), Here());}
 
+  // Whether leftInverseMultiply and iterativeCalibrationUpdate make no MPI call, so that the
+  // next ensemble members can be read while they run
+  virtual bool communicationFreeCalibration() const {return false;}
+
   // Dual resolution setup
   virtual void dualResolutionSetup(const oops::GeometryData &)
     {throw eckit::NotImplemented("dualResolutionSetup not implemented yet for the block "
@@ -133,6 +151,10 @@ class SaberOuterBlockBase : public util::Printable, private boost::noncopyable {
                                 const double & tol) const
     {return fset3D1.compare_with(fset3D2, tol, util::ToleranceType::normalized_absolute);}
 
+  // Pointwise factors if the block is a self-adjoint multiplication by fields (to fuse consecutive
+  // pointwise blocks in the outer block chain), nullptr otherwise
+  virtual const oops::FieldSet3D * pointwiseFactors() const {return nullptr;}
+
   // Non-virtual methods
 
   // Return block name
@@ -147,6 +169,10 @@ class SaberOuterBlockBase : public util::Printable, private boost::noncopyable {
   // Return date/time
   const util::DateTime validTime() const {return validTime_;}
 
+  // Return numbers of output fields allocated and reused from the field pool
+  size_t fieldAllocations() const {return fieldAllocations_;}
+  size_t fieldReuses() const {return fieldReuses_;}
+
   // Read model fields
   template <typename MODEL>
   void read(const oops::Geometry<MODEL> &,
@@ -177,10 +203,18 @@ class SaberOuterBlockBase : public util::Printable, private boost::noncopyable {
  protected:
   const util::DateTime validTime_;
 
+  // Zero output field from the block field pool: a pooled field with the same function space,
+  // name and levels is reused if the block holds the only reference to it, otherwise a new
+  // field is allocated and added to the pool
+  atlas::Field pooledField(const atlas::FunctionSpace &, const atlas::util::Config &) const;
+
  private:
   const std::string blockName_;
   const bool skipInverse_;
   const bool filterMode_;
+  mutable std::vector<atlas::Field> fieldPool_;
+  mutable size_t fieldAllocations_;
+  mutable size_t fieldReuses_;
   virtual void print(std::ostream &) const = 0;
 };
 
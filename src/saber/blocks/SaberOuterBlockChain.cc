@@ -7,12 +7,14 @@
  */
 
 #include <memory>
+#include <string>
 #include <tuple>
 #include <vector>
 
 #include "eckit/config/LocalConfiguration.h"
 #include "eckit/exception/Exceptions.h"
 
+#include "oops/base/FieldSet3D.h"
 #include "oops/base/FieldSet4D.h"
 #include "oops/base/GeometryData.h"
 #include "oops/base/Variables.h"
@@ -98,9 +100,68 @@ SaberOuterBlockChain::SaberOuterBlockChain(
                        innerVars,
                        activeVars);
   }
+  plan();
   oops::Log::trace() << "SaberOuterBlockChain generic ctor done" << std::endl;
 }
 
+// -----------------------------------------------------------------------------
+
+SaberOuterBlockChain::~SaberOuterBlockChain() {
+  oops::Log::trace() << "SaberOuterBlockChain dtor starting" << std::endl;
+  // Output field allocations (timings are reported by the timers)
+  for (const auto & block : outerBlocks_) {
+    if (block->fieldAllocations()+block->fieldReuses() > 0) {
+      oops::Log::info() << "Info     : Outer block " << block->blockName() << ": "
+                        << block->fieldAllocations() << " output field allocation(s), "
+                        << block->fieldReuses() << " reuse(s)" << std::endl;
+    }
+  }
+  oops::Log::trace() << "SaberOuterBlockChain dtor done" << std::endl;
+}
+
+// -----------------------------------------------------------------------------
+
+void SaberOuterBlockChain::plan() const {
+  oops::Log::trace() << "SaberOuterBlockChain::plan starting" << std::endl;
+
+  const size_t nblocks = outerBlocks_.size();
+  runFirst_.resize(nblocks);
+  runLast_.resize(nblocks);
+  fusedFactors_.clear();
+  fusedFactors_.resize(nblocks);
+
+  size_t jb = 0;
+  while (jb < nblocks) {
+    // Find the run of pointwise blocks with the same variables starting at this block
+    const oops::FieldSet3D * factors = outerBlocks_[jb]->pointwiseFactors();
+    size_t jl = jb;
+    if (factors) {
+      while (jl+1 < nblocks && outerBlocks_[jl+1]->pointwiseFactors()
+        && outerBlocks_[jl+1]->pointwiseFactors()->field_names() == factors->field_names()) {
+        ++jl;
+      }
+    }
+    for (size_t jj = jb; jj <= jl; ++jj) {
+      runFirst_[jj] = jb;
+      runLast_[jj] = jl;
+    }
+
+    if (jl > jb) {
+      // Product of the factors
+      oops::Log::info() << "Info     : Fuse pointwise outer blocks " << jb << " to " << jl
+                        << std::endl;
+      fusedFactors_[jb].reset(new oops::FieldSet3D(factors->validTime(), factors->commGeom()));
+      fusedFactors_[jb]->deepCopy(factors->fieldSet());
+      for (size_t jj = jb+1; jj <= jl; ++jj) {
+        *fusedFactors_[jb] *= *outerBlocks_[jj]->pointwiseFactors();
+      }
+    }
+    jb = jl+1;
+  }
+
+  oops::Log::trace() << "SaberOuterBlockChain::plan done" << std::endl;
+}
+
 // -----------------------------------------------------------------------------
 std::tuple<const SaberBlockParametersBase&, oops::Variables, oops::Variables>
     SaberOuterBlockChain::initBlock(
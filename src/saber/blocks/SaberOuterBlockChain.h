@@ -11,6 +11,7 @@
 #include <iostream>
 #include <memory>
 #include <sstream>
+#include <string>
 #include <tuple>
 #include <vector>
 
@@ -23,6 +24,7 @@
 #include "oops/base/Geometry.h"
 #include "oops/base/GeometryData.h"
 #include "oops/interface/ModelData.h"
+#include "oops/util/Timer.h"
 
 #include "saber/blocks/SaberBlockParametersBase.h"
 #include "saber/blocks/SaberOuterBlockBase.h"
@@ -38,6 +40,8 @@ namespace saber {
 /// covariances, ensemble transform for the ensemble covariance.
 class SaberOuterBlockChain {
  public:
+  static const std::string classname() {return "saber::SaberOuterBlockChain";}
+
   /// @brief Standard constructor using MODEL geometry
   template<typename MODEL>
   SaberOuterBlockChain(const oops::Geometry<MODEL> & geom,
@@ -55,7 +59,7 @@ class SaberOuterBlockChain {
                        const eckit::LocalConfiguration & covarConf,
                        const std::vector<saber::SaberOuterBlockParametersWrapper> & params);
 
-  ~SaberOuterBlockChain() = default;
+  ~SaberOuterBlockChain();
 
   // Accessors
   const std::vector<std::unique_ptr<SaberOuterBlockBase>> & outerBlocks() const
@@ -75,18 +79,74 @@ class SaberOuterBlockChain {
 
   /// @brief Forward multiplication by all outer blocks.
   void applyOuterBlocks(oops::FieldSet4D & fset4d) const {
+    if (runFirst_.size() != outerBlocks_.size()) plan();
     for (size_t jtime = 0; jtime < fset4d.size(); ++jtime) {
-      for (auto it = outerBlocks_.rbegin(); it != outerBlocks_.rend(); ++it) {
-        it->get()->multiply(fset4d[jtime]);
+      for (size_t jj = outerBlocks_.size(); jj > 0; --jj) {
+        const size_t jb = jj-1;
+        if (fusedFactors_[runFirst_[jb]]) {
+          // Fused pointwise blocks
+          util::Timer timer(classname(), "fusedPointwise");
+          fset4d[jtime] *= *fusedFactors_[runFirst_[jb]];
+          jj = runFirst_[jb]+1;
+        } else {
+          util::Timer timer("saber::" + outerBlocks_[jb]->blockName(), "multiply");
+          outerBlocks_[jb]->multiply(fset4d[jtime]);
+        }
       }
     }
   }
 
   /// @brief Adjoint multiplication by all outer blocks.
   void applyOuterBlocksAD(oops::FieldSet4D & fset4d) const {
+    if (runFirst_.size() != outerBlocks_.size()) plan();
     for (size_t jtime = 0; jtime < fset4d.size(); ++jtime) {
-      for (auto it = outerBlocks_.begin(); it != outerBlocks_.end(); ++it) {
-        it->get()->multiplyAD(fset4d[jtime]);
+      for (size_t jb = 0; jb < outerBlocks_.size(); ++jb) {
+        if (fusedFactors_[runFirst_[jb]]) {
+          // Fused pointwise blocks (self-adjoint)
+          util::Timer timer(classname(), "fusedPointwise");
+          fset4d[jtime] *= *fusedFactors_[runFirst_[jb]];
+          jb = runLast_[jb];
+        } else {
+          util::Timer timer("saber::" + outerBlocks_[jb]->blockName(), "multiplyAD");
+          outerBlocks_[jb]->multiplyAD(fset4d[jtime]);
+        }
+      }
+    }
+  }
+
+  /// @brief Forward multiplication by all outer blocks, for a batch of FieldSets.
+  void applyOuterBlocks(std::vector<oops::FieldSet3D> & fsets) const {
+    if (runFirst_.size() != outerBlocks_.size()) plan();
+    for (size_t jj = outerBlocks_.size(); jj > 0; --jj) {
+      const size_t jb = jj-1;
+      if (fusedFactors_[runFirst_[jb]]) {
+        // Fused pointwise blocks
+        util::Timer timer(classname(), "fusedPointwise");
+        for (auto & fset : fsets) {
+          fset *= *fusedFactors_[runFirst_[jb]];
+        }
+        jj = runFirst_[jb]+1;
+      } else {
+        util::Timer timer("saber::" + outerBlocks_[jb]->blockName(), "multiplyBatch");
+        outerBlocks_[jb]->multiplyBatch(fsets);
+      }
+    }
+  }
+
+  /// @brief Adjoint multiplication by all outer blocks, for a batch of FieldSets.
+  void applyOuterBlocksAD(std::vector<oops::FieldSet3D> & fsets) const {
+    if (runFirst_.size() != outerBlocks_.size()) plan();
+    for (size_t jb = 0; jb < outerBlocks_.size(); ++jb) {
+      if (fusedFactors_[runFirst_[jb]]) {
+        // Fused pointwise blocks (self-adjoint)
+        util::Timer timer(classname(), "fusedPointwise");
+        for (auto & fset : fsets) {
+          fset *= *fusedFactors_[runFirst_[jb]];
+        }
+        jb = runLast_[jb];
+      } else {
+        util::Timer timer("saber::" + outerBlocks_[jb]->blockName(), "multiplyADBatch");
+        outerBlocks_[jb]->multiplyADBatch(fsets);
       }
     }
   }
@@ -176,10 +236,22 @@ class SaberOuterBlockChain {
                           const oops::Variables & innerVars,
                           const oops::Variables & activeVars) const;
 
+  /// @brief Application plan: find the runs of consecutive pointwise blocks with the same
+  ///        variables and precompute the product of their factors, so that each run is applied
+  ///        in a single pass over memory. Called at the end of the constructors, and again if
+  ///        blocks are added to the chain afterwards.
+  void plan() const;
+
   /// @brief Vector of all outer blocks.
   /// TODO(AS): Need to expand this to create different outer blocks for different
   /// times for the 4D with multiple times on one MPI task.
   std::vector<std::unique_ptr<SaberOuterBlockBase>> outerBlocks_;
+
+  /// @brief First and last block of the pointwise run containing each block, and fused factors
+  ///        of the runs of more than one block (indexed by their first block).
+  mutable std::vector<size_t> runFirst_;
+  mutable std::vector<size_t> runLast_;
+  mutable std::vector<std::unique_ptr<oops::FieldSet3D>> fusedFactors_;
 };
 
 // -----------------------------------------------------------------------------
@@ -256,6 +328,7 @@ SaberOuterBlockChain::SaberOuterBlockChain(const oops::Geometry<MODEL> & geom,
                        innerVars,
                        activeVars);
   }
+  plan();
   oops::Log::trace() << "SaberOuterBlockChain ctor done" << std::endl;
 }
 
@@ -285,21 +358,38 @@ void SaberOuterBlockChain::calibrateBlock(
     // Get ensemble size
     const size_t nens = ensembleConf.getInt("ensemble size");
 
-    for (size_t ie = 0; ie < nens; ++ie) {
-      // Read ensemble member
-      oops::FieldSet3D fset(fset4dXb[0].validTime(), geom.getComm());
-      readEnsembleMember(geom,
-                         outerVars,
-                         ensembleConf,
-                         ie,
-                         fset);
+    // Reading ahead is only possible if the processing of a member makes no MPI call
+    size_t prefetchDepth = covarConf.getUnsigned("iterative ensemble loading prefetch depth", 0);
+    if (prefetchDepth > 0) {
+      for (const auto & outerBlock : outerBlocks_) {
+        if (!outerBlock->communicationFreeCalibration()) {
+          oops::Log::info() << "Info     : Warning: block " << outerBlock->blockName()
+                            << " communicates during the iterative calibration, ensemble "
+                            << "members are read synchronously" << std::endl;
+          prefetchDepth = 0;
+          break;
+        }
+      }
+    }
+
+    // Loop over ensemble members (reading ahead if required)
+    forEachEnsembleMember(geom,
+                          outerVars,
+                          ensembleConf,
+                          fset4dXb[0].validTime(),
+                          nens,
+                          prefetchDepth,
+                          covarConf.getDouble("iterative ensemble loading prefetch memory", 0.0),
+                          [this](oops::FieldSet3D & fset) {
       // Apply outer blocks inverse (except last)
       this->leftInverseMultiplyExceptLast(fset);
 
       // Use FieldSet in the central block
+      # pragma omp critical(saber_ensemble_log)
       oops::Log::info() << "Info     : Use FieldSet in the central block" << std::endl;
       outerBlocks_.back()->iterativeCalibrationUpdate(fset);
-    }
+    });
+
     // Finalization
     oops::Log::info() << "Info     : Finalization" << std::endl;
     outerBlocks_.back()->iterativeCalibrationFinal();
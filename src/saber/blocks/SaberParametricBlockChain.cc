@@ -5,10 +5,13 @@
  * which can be obtained at http://www.apache.org/licenses/LICENSE-2.0.
  */
 
+#include <string>
 #include <tuple>
 
 #include "saber/blocks/SaberParametricBlockChain.h"
 
+#include "oops/util/Timer.h"
+
 #include "saber/oops/Utilities.h"
 
 namespace saber {
@@ -26,6 +29,7 @@ SaberParametricBlockChain::SaberParametricBlockChain(
   : outerFunctionSpace_(outerGeometryData.functionSpace()),
     outerVariables_(outerVars),
     crossTimeCov_(covarConf.getString("time covariance") == "multivariate duplicated"),
+    timeAllReduce_(timeAllReduce(covarConf)),
     timeComm_(fset4dXb.commTime()),
     size4D_(fset4dXb.size()) {
   oops::Log::trace() << "SaberParametricBlockChain generic ctor starting" << std::endl;
@@ -224,20 +228,21 @@ void SaberParametricBlockChain::multiply(oops::FieldSet4D & fset4d) const {
     for (size_t jtime = 1; jtime < fset4d.size(); ++jtime) {
       fset4d[0] += fset4d[jtime];
     }
-    if (timeComm_.rank() > 0) {
-      oops::mpi::send(timeComm_, fset4d[0], 0, 0);
+    if (timeAllReduce_) {
+      // Global sum of x1, x2, ... on all tasks
+      sumOverTime(fset4d[0], true);
+      // Compute C * (x1+x2+...) on all tasks
+      centralBlock_->multiply(fset4d[0]);
     } else {
-      // On rank 0 receive other local sums and compute global sum of x1, x2, ...
-      oops::FieldSet3D fset3d_tmp = oops::initFieldSet3D(fset4d[0]);
-      for (size_t jj = 1; jj < timeComm_.size(); ++jj) {
-        oops::mpi::receive(timeComm_, fset3d_tmp, jj, 0);
-        fset4d[0] += fset3d_tmp;
+      // Global sum of x1, x2, ... on rank 0
+      sumOverTime(fset4d[0], false);
+      if (timeComm_.rank() == 0) {
+        // Compute C * (x1+x2+...)
+        centralBlock_->multiply(fset4d[0]);
       }
-      // Compute C * (x1+x2+...)
-      centralBlock_->multiply(fset4d[0]);
+      // Broadcast the result to all tasks
+      oops::mpi::broadcast(timeComm_, fset4d[0], 0);
     }
-    // Broadcast the result to all tasks
-    oops::mpi::broadcast(timeComm_, fset4d[0], 0);
     // Deep copy of the result to all the local time slots
     for (size_t jt = 1; jt < fset4d.local_time_size(); ++jt) {
       fset4d[jt].deepCopy(fset4d[0].fieldSet());
@@ -256,6 +261,48 @@ void SaberParametricBlockChain::multiply(oops::FieldSet4D & fset4d) const {
   }
 }
 
+// -----------------------------------------------------------------------------
+
+void SaberParametricBlockChain::multiply(
+  const std::vector<oops::FieldSet4D *> & fset4ds) const {
+  if (fset4ds.empty()) return;
+
+  if (crossTimeCov_) {
+    // Duplicated cross-time covariances: the time slots are summed before the central block,
+    // apply the chain to each batch member
+    for (auto & fset4d : fset4ds) {
+      multiply(*fset4d);
+    }
+    return;
+  }
+
+  // No cross-time covariances: apply the chain to each of the time slots, for all the
+  // batch members at once
+  for (size_t jtime = 0; jtime < fset4ds[0]->size(); ++jtime) {
+    std::vector<oops::FieldSet3D> fsets;
+    for (const auto & fset4d : fset4ds) {
+      fsets.push_back((*fset4d)[jtime]);
+    }
+
+    // Outer blocks adjoint multiplication
+    if (outerBlockChain_) {
+      outerBlockChain_->applyOuterBlocksAD(fsets);
+    }
+
+    // Central block multiplication
+    centralBlock_->multiplyBatch(fsets);
+
+    // Outer blocks forward multiplication
+    if (outerBlockChain_) {
+      outerBlockChain_->applyOuterBlocks(fsets);
+    }
+
+    // Blocks can replace the fields of their input FieldSet
+    for (size_t jb = 0; jb < fset4ds.size(); ++jb) {
+      (*fset4ds[jb])[jtime].fieldSet() = fsets[jb].fieldSet();
+    }
+  }
+}
 
 // -----------------------------------------------------------------------------
 
@@ -365,16 +412,9 @@ void SaberParametricBlockChain::multiplySqrtAD(const oops::FieldSet4D & fset4d,
     for (size_t jtime = 1; jtime < fset4dCopy.size(); ++jtime) {
       fset4dCopy[0] += fset4dCopy[jtime];
     }
-    if (timeComm_.rank() > 0) {
-      oops::mpi::send(timeComm_, fset4dCopy[0], 0, 0);
-    } else {
-      // On rank 0 receive other local sums and compute global sum of x1, x2, ...
-      oops::FieldSet3D fset3d_tmp = oops::initFieldSet3D(fset4dCopy[0]);
-      for (size_t jj = 1; jj < timeComm_.size(); ++jj) {
-        oops::mpi::receive(timeComm_, fset3d_tmp, jj, 0);
-        fset4dCopy[0] += fset3d_tmp;
-      }
-
+    // Global sum of x1, x2, ... on rank 0 (the control vector only lives there)
+    sumOverTime(fset4dCopy[0], false);
+    if (timeComm_.rank() == 0) {
       // Central block square-root adjoint for rank 0
       centralBlock_->multiplySqrtAD(fset4dCopy[0], cv, offset);
     }
@@ -390,5 +430,34 @@ void SaberParametricBlockChain::multiplySqrtAD(const oops::FieldSet4D & fset4d,
 
 // -----------------------------------------------------------------------------
 
+bool SaberParametricBlockChain::timeAllReduce(const eckit::Configuration & covarConf) {
+  const std::string reduction = covarConf.getString("time covariance reduction", "reduce");
+  if (reduction != "reduce" && reduction != "allreduce") {
+    throw eckit::UserError("Wrong time covariance reduction: " + reduction, Here());
+  }
+  return reduction == "allreduce";
+}
+
+// -----------------------------------------------------------------------------
+
+void SaberParametricBlockChain::sumOverTime(oops::FieldSet3D & fset3d,
+                                            const bool & all) const {
+  util::Timer timer("saber::SaberParametricBlockChain", all ? "allReduceOverTime"
+                                                            : "reduceOverTime");
+
+  if (timeComm_.size() == 1) return;
+
+  // Tree-based reduction, field by field
+  for (auto & field : fset3d.fieldSet()) {
+    double * ptr = field.array().data<double>();
+    if (all) {
+      timeComm_.allReduceInPlace(ptr, field.size(), eckit::mpi::sum());
+    } else {
+      timeComm_.reduceInPlace(ptr, field.size(), eckit::mpi::sum(), 0);
+    }
+  }
+}
+
+// -----------------------------------------------------------------------------
 
 }  // namespace saber
@@ -61,6 +61,8 @@ class SaberParametricBlockChain : public SaberBlockChainBase {
   void randomize(oops::FieldSet4D &) const;
   /// @brief Multiply the increment by this B matrix.
   void multiply(oops::FieldSet4D &) const;
+  /// @brief Multiply a batch of increments by this B matrix, one time slot at a time.
+  void multiply(const std::vector<oops::FieldSet4D *> &) const;
   /// @brief Get this B matrix square-root control vector size.
   size_t ctlVecSize() const;
   /// @brief Multiply the control vector by this B matrix square-root.
@@ -84,6 +86,12 @@ class SaberParametricBlockChain : public SaberBlockChainBase {
                        const oops::FieldSet4D & fset4dXb,
                        const oops::FieldSet4D & fset4dFg);
 
+  /// @brief Read the time covariance reduction option. Used in constructors.
+  static bool timeAllReduce(const eckit::Configuration & covarConf);
+
+  /// @brief Sum a FieldSet over the time communicator, on the first task or on all tasks.
+  void sumOverTime(oops::FieldSet3D &, const bool & all) const;
+
   /// @brief Run adjoint and square-root tests on central block. Used in constructors.
   void testCentralBlock(const eckit::LocalConfiguration & covarConf,
                         const SaberBlockParametersBase & saberCentralBlockParams,
@@ -96,6 +104,7 @@ class SaberParametricBlockChain : public SaberBlockChainBase {
   const oops::Variables outerVariables_;
   std::unique_ptr<SaberOuterBlockChain> outerBlockChain_;
   const bool crossTimeCov_;
+  const bool timeAllReduce_;
   std::unique_ptr<SaberCentralBlockBase> centralBlock_;
   const eckit::mpi::Comm & timeComm_;
   size_t size4D_;
@@ -119,6 +128,7 @@ SaberParametricBlockChain::SaberParametricBlockChain(const oops::Geometry<MODEL>
                        const eckit::Configuration & conf)
   : outerFunctionSpace_(geom.functionSpace()), outerVariables_(outerVars),
   crossTimeCov_(covarConf.getString("time covariance") == "multivariate duplicated"),
+  timeAllReduce_(timeAllReduce(covarConf)),
   timeComm_(fset4dXb.commTime()), size4D_(fset4dXb.size()) {
   oops::Log::trace() << "SaberParametricBlockChain ctor starting" << std::endl;
 
@@ -5,14 +5,22 @@
  * which can be obtained at http://www.apache.org/licenses/LICENSE-2.0.
  */
 #include <algorithm>
+#include <cmath>
 #include <limits>
+#include <string>
+#include <vector>
+
+#include "atlas/parallel/omp/omp.h"
+#include "atlas/util/Earth.h"
 
 #include "oops/generic/Diffusion.h"
 #include "oops/util/FieldSetHelpers.h"
 #include "oops/util/FieldSetOperations.h"
 #include "oops/util/Logger.h"
+#include "oops/util/Timer.h"
 
 #include "saber/diffusion/Diffusion.h"
+#include "saber/util/CounterBasedRandom.h"
 
 namespace saber {
 
@@ -98,6 +106,7 @@ void Diffusion::randomize(oops::FieldSet3D & fset) const {
 // --------------------------------------------------------------------------------------
 
 void Diffusion::multiply(oops::FieldSet3D & fset) const {
+  util::Timer timer(classname(), "multiply");
   const atlas::FunctionSpace & fs = geom_.functionSpace();
 
   // iterate through the list of groups
@@ -178,40 +187,92 @@ void Diffusion::multiply(oops::FieldSet3D & fset) const {
       }
     }
 
-    // Do the diffusion for each field
-    for (auto & field : fieldSubset) {
-      atlas::FieldSet fset;
-      if (group.vtDuplicated) {
-        // merge vertical levels
-        atlas::Field common = fs.createField<double>(atlas::option::levels(1));
-        auto v_common = atlas::array::make_view<double, 2>(common);
-        auto v_field = atlas::array::make_view<double, 2>(field);
-        v_common.assign(0.0);
+    // Horizontal-only diffusion with 2D parameters is applied level by level, so the fields
+    // of the group can be stacked along the level dimension and processed together: one halo
+    // exchange and one diffusion sweep for the whole group instead of one per field.
+    const bool stacked = !group.normalization.has("vtNorm") &&
+      (!group.normalization.has("hzNorm") || group.normalization["hzNorm"].shape(1) == 1);
+
+    if (stacked) {
+      // level offset of each field in the stack
+      std::vector<atlas::idx_t> offsets{0};
+      for (const auto & field : fieldSubset) {
+        offsets.push_back(offsets.back() + (group.vtDuplicated ? 1 : field.shape(1)));
+      }
+      atlas::Field stack = fs.createField<double>(
+        atlas::option::levels(offsets.back()) | atlas::option::name("STACK"));
+      auto v_stack = atlas::array::make_view<double, 2>(stack);
+      v_stack.assign(0.0);
+
+      // copy the fields into the stack, merging vertical levels if needed
+      for (atlas::idx_t jf = 0; jf < fieldSubset.size(); jf++) {
+        const atlas::Field & field = fieldSubset[jf];
+        const auto & v_field = atlas::array::make_view<double, 2>(field);
         for (atlas::idx_t i = 0; i < fs.size(); i++) {
           for (atlas::idx_t lvl = 0; lvl < field.shape(1); lvl++) {
-            v_common(i, 0) += v_field(i, lvl);
+            if (group.vtDuplicated) {
+              v_stack(i, offsets[jf]) += v_field(i, lvl);
+            } else {
+              v_stack(i, offsets[jf]+lvl) = v_field(i, lvl);
+            }
           }
         }
-        fset.add(common);
-
-        // do diffusion
-        applyNormSqrt(common);
-        group.diffusion->multiplySqrtAD(fset);
-        group.diffusion->multiplySqrtTL(fset);
-        applyNormSqrt(common);
+      }
 
-        // put vertical levels back to source
+      // do diffusion
+      atlas::FieldSet stackSet;
+      stackSet.add(stack);
+      applyNormSqrt(stack);
+      group.diffusion->multiplySqrtAD(stackSet);
+      group.diffusion->multiplySqrtTL(stackSet);
+      applyNormSqrt(stack);
+
+      // put the fields back to source
+      for (atlas::idx_t jf = 0; jf < fieldSubset.size(); jf++) {
+        atlas::Field & field = fieldSubset[jf];
+        auto v_field = atlas::array::make_view<double, 2>(field);
         for (atlas::idx_t i = 0; i < fs.size(); i++) {
           for (atlas::idx_t lvl = 0; lvl < field.shape(1); lvl++) {
-            v_field(i, lvl) = v_common(i, 0);
+            v_field(i, lvl) = v_stack(i, offsets[jf] + (group.vtDuplicated ? 0 : lvl));
           }
         }
-      } else {
-        fset.add(field);
-        applyNormSqrt(field);
-        group.diffusion->multiplySqrtAD(fset);
-        group.diffusion->multiplySqrtTL(fset);
-        applyNormSqrt(field);
+      }
+    } else {
+      // Do the diffusion for each field
+      for (auto & field : fieldSubset) {
+        atlas::FieldSet fset;
+        if (group.vtDuplicated) {
+          // merge vertical levels
+          atlas::Field common = fs.createField<double>(atlas::option::levels(1));
+          auto v_common = atlas::array::make_view<double, 2>(common);
+          auto v_field = atlas::array::make_view<double, 2>(field);
+          v_common.assign(0.0);
+          for (atlas::idx_t i = 0; i < fs.size(); i++) {
+            for (atlas::idx_t lvl = 0; lvl < field.shape(1); lvl++) {
+              v_common(i, 0) += v_field(i, lvl);
+            }
+          }
+          fset.add(common);
+
+          // do diffusion
+          applyNormSqrt(common);
+          group.diffusion->multiplySqrtAD(fset);
+          group.diffusion->multiplySqrtTL(fset);
+          applyNormSqrt(common);
+
+          // put vertical levels back to source
+          for (atlas::idx_t i = 0; i < fs.size(); i++) {
+            for (atlas::idx_t lvl = 0; lvl < field.shape(1); lvl++) {
+              v_field(i, lvl) = v_common(i, 0);
+            }
+          }
+        } else {
+          fset.add(field);
+          applyNormSqrt(field);
+          group.diffusion->multiplySqrtAD(fset);
+          group.diffusion->multiplySqrtTL(fset);
+          applyNormSqrt(field);
+        }
       }
     }
 
@@ -519,7 +580,8 @@ void Diffusion::directCalibration(const oops::FieldSets &) {
     // will eventually converge to the true normalization coefficients, given enough
     // iterations. The process is to 1) create a random field 2) apply the sqrt of
     // diffusion 3) keep track of the running variance 4) repeat, and when done, the
-    // normalization is a function of this variance.
+    // normalization is a function of this variance. Alternatively, the variance can be
+    // probed directly with coloured vectors (see horizontalNormalizationProbing).
     // ------------------------------------------------------------------------------------
     if (groupConf.horizontal.value() != boost::none) {
       oops::Log::info() << "Calculating horizontal normalization...\n";
@@ -533,60 +595,25 @@ void Diffusion::directCalibration(const oops::FieldSets &) {
       auto v_normHz = atlas::array::make_view<double, 2>(normHz);
       v_normHz.assign(1.0);
 
-      // fields that are needed to keep a running variance calculation
-      atlas::Field s = fs.createField<double>(atlas::option::levels(levels));
-      atlas::Field m = fs.createField<double>(atlas::option::levels(levels));
-      auto v_s = atlas::array::make_view<double, 2>(s);
-      auto v_m = atlas::array::make_view<double, 2>(m);
-      v_s.assign(0.0);
-      v_m.assign(0.0);
-
-      // Perform multiple iterations of calculating the variance of the diffusion operator
-      // when random vectors are supplied
-      oops::Log::info() << "  randomization iterations: " << randomizationIterations << std::endl;
-      oops::Log::info() << "  status:  0%"<< std::endl;
-      const int n10pct = std::floor(randomizationIterations/10.0);
-      for (int itr = 1; itr <= randomizationIterations; itr++) {
-        if ( itr % n10pct == 0 ) {
-          oops::Log::info() << "          " << 10*itr/n10pct << "%" << std::endl;
-        }
-
-        // generate random vector
-        atlas::FieldSet rand = util::createRandomFieldSet(geom_.comm(), fs,
-          std::vector<size_t>{levels}, std::vector<std::string>{"rand"});
-
-        // apply sqrt of horizontal diffusion
-        group.diffusion->multiplySqrtTL(rand, oops::Diffusion::Mode::HorizontalOnly);
-
-        // keep track of the stats needed for a running variance calculation
-        // (Welford 1962 algorithm)
-        const auto & v_rand = atlas::array::make_view<double, 2>(rand["rand"]);
-        double new_m;
-        for (atlas::idx_t i = 0; i < fs.size(); i++) {
-          for (size_t lvl = 0; lvl < levels; lvl++) {
-            const double m = v_m(i, lvl);
-            const double f = v_rand(i, lvl);
-            new_m = m + (f - m) / itr;
-            v_s(i, lvl) += (f - m)*(f - new_m);
-            v_m(i, lvl) = new_m;
-          }
-        }
-      }  // done with randomization iterations
-
-      // calculate final normalization coefficients
-      for (atlas::idx_t i = 0; i < fs.size(); i++) {
-        for (size_t lvl = 0; lvl < levels; lvl++) {
-          if (v_s(i, lvl) > 0.0) {
-            v_normHz(i, lvl) = 1.0 / sqrt(v_s(i, lvl) / (randomizationIterations-1));
-          }
-        }
+      const std::string method = calibrationParams.normalizationMethod.value();
+      oops::Log::info() << "  method: " << method << std::endl;
+      if (method == "randomization") {
+        horizontalNormalizationRandomized(group, randomizationIterations, normHz);
+      } else if (method == "probing") {
+        horizontalNormalizationProbing(group, calibrationParams, scales["hzScales"], normHz);
+      } else {
+        throw eckit::UserError("saber::Diffusion: wrong normalization method: " + method,
+                               Here());
       }
     }
 
     // ------------------------------------------------------------------------------------
-    // Calculate vertical normalization. This is done using a brute force method. A dirac
-    // is created at each level, vertical diffusion is applied, and the normalization is
-    // calculated from that
+    // Calculate vertical normalization. A dirac is created at each level, vertical
+    // diffusion is applied, and the normalization is calculated from that. The vertical
+    // diffusion only spreads over a limited number of levels, so that levels whose responses
+    // do not overlap can share the same application ("banded" method) and give the same
+    // result as one dirac per level ("brute force" method). The responses of all the probed
+    // levels are checked, since the vertical scales can vary with the level and the location.
     // ------------------------------------------------------------------------------------
     if (groupConf.vertical.value() != boost::none) {
       oops::Log::info() << "Calculating vertical normalization...\n";
@@ -599,28 +626,45 @@ void Diffusion::directCalibration(const oops::FieldSets &) {
       auto v_normVt = atlas::array::make_view<double, 2>(normVt);
       v_normVt.assign(1.0);
 
-      atlas::FieldSet normLvl = util::createFieldSet(fs,
-        std::vector<size_t>{levels}, std::vector<std::string>{"norm"});
-      auto v_normLvl = atlas::array::make_view<double, 2>(normLvl["norm"]);
-
-      // for each level
-      for (size_t lvl = 0; lvl < levels; lvl++) {
-        // assign 0 everywhere except 1.0 for the current level
-        v_normLvl.assign(0.0);
-        for (atlas::idx_t i = 0; i < fs.size(); i++) {
-          v_normLvl(i, lvl) = 1.0;
+      const std::string method = calibrationParams.verticalNormalizationMethod.value();
+      oops::Log::info() << "  method: " << method << std::endl;
+      size_t stride = levels;
+      if (method == "banded") {
+        // initial stride from the reach of a dirac at the middle level, doubled until the
+        // responses of the levels probed together do not overlap in any column
+        stride = std::min(2*verticalBandwidth(group, levels)+2, levels);
+        while (!verticalNormalization(group, stride, normVt)) {
+          stride = std::min(2*stride, levels);
+          oops::Log::info() << "  overlapping responses, stride increased to " << stride
+                            << std::endl;
         }
+      } else if (method == "brute force") {
+        verticalNormalization(group, stride, normVt);
+      } else {
+        throw eckit::UserError("saber::Diffusion: wrong vertical normalization method: "
+                               + method, Here());
+      }
 
-        // apply vertical diffusion
-        group.diffusion->multiplySqrtAD(normLvl, oops::Diffusion::Mode::VerticalOnly);
-        group.diffusion->multiplySqrtTL(normLvl, oops::Diffusion::Mode::VerticalOnly);
-
-        // save the normalization coefficients for this level
+      // optional validation against the brute force method
+      if (calibrationParams.verticalValidation.value() && stride < levels) {
+        atlas::Field refNorm = fs.createField<double>(atlas::option::levels(levels));
+        auto v_refNorm = atlas::array::make_view<double, 2>(refNorm);
+        v_refNorm.assign(1.0);
+        verticalNormalization(group, levels, refNorm);
+        double diffMax = 0.0;
         for (atlas::idx_t i = 0; i < fs.size(); i++) {
-          if (v_normLvl(i, lvl) > 0.0) {
-            v_normVt(i, lvl) = 1.0 / sqrt(v_normLvl(i, lvl));
+          for (size_t lvl = 0; lvl < levels; lvl++) {
+            diffMax = std::max(diffMax,
+              std::abs(v_normVt(i, lvl)-v_refNorm(i, lvl))/v_refNorm(i, lvl));
           }
         }
+        geom_.comm().allReduceInPlace(diffMax, eckit::mpi::max());
+        oops::Log::info() << "  validation: maximum relative difference with brute force = "
+                          << diffMax << std::endl;
+        if (diffMax > 1.0e-12) {
+          throw eckit::Exception("saber::Diffusion: banded vertical normalization validation "
+                                 "failed", Here());
+        }
       }
     }
 
@@ -641,4 +685,354 @@ void Diffusion::directCalibration(const oops::FieldSets &) {
 
 // --------------------------------------------------------------------------------------
 
+size_t Diffusion::verticalBandwidth(const Group & group, const size_t levels) const {
+  // Number of levels reached by the vertical diffusion from a dirac at the middle level, used
+  // as a first guess for the banded normalization. If the response reaches the top or the
+  // bottom, the bandwidth is set to the number of levels.
+  const atlas::FunctionSpace & fs = geom_.functionSpace();
+  const int midLvl = levels/2;
+
+  atlas::FieldSet probe = util::createFieldSet(fs,
+    std::vector<size_t>{levels}, std::vector<std::string>{"probe"});
+  auto v_probe = atlas::array::make_view<double, 2>(probe["probe"]);
+  v_probe.assign(0.0);
+  for (atlas::idx_t i = 0; i < fs.size(); i++) {
+    v_probe(i, midLvl) = 1.0;
+  }
+  group.diffusion->multiplySqrtAD(probe, oops::Diffusion::Mode::VerticalOnly);
+  group.diffusion->multiplySqrtTL(probe, oops::Diffusion::Mode::VerticalOnly);
+
+  int minLvl = midLvl;
+  int maxLvl = midLvl;
+  for (atlas::idx_t i = 0; i < fs.size(); i++) {
+    for (size_t lvl = 0; lvl < levels; lvl++) {
+      if (v_probe(i, lvl) != 0.0) {
+        minLvl = std::min(minLvl, static_cast<int>(lvl));
+        maxLvl = std::max(maxLvl, static_cast<int>(lvl));
+      }
+    }
+  }
+  geom_.comm().allReduceInPlace(minLvl, eckit::mpi::min());
+  geom_.comm().allReduceInPlace(maxLvl, eckit::mpi::max());
+
+  size_t bandwidth = levels;
+  if (minLvl > 0 && maxLvl < static_cast<int>(levels)-1) {
+    bandwidth = static_cast<size_t>(std::max(midLvl-minLvl, maxLvl-midLvl));
+  }
+  oops::Log::info() << "  vertical bandwidth: " << bandwidth << " levels" << std::endl;
+  return bandwidth;
+}
+
+// --------------------------------------------------------------------------------------
+
+bool Diffusion::verticalNormalization(const Group & group,
+                                      const size_t stride,
+                                      atlas::Field & normVt) const {
+  // Levels lvl0, lvl0+stride, lvl0+2*stride... are probed in the same application. Returns
+  // false if, in any column, the responses of two levels probed together overlap, in which
+  // case the normalization has to be computed again with a larger stride.
+  const atlas::FunctionSpace & fs = geom_.functionSpace();
+  const size_t levels = normVt.shape(1);
+  const size_t nApplications = std::min(stride, levels);
+  oops::Log::info() << "  applications: " << nApplications << std::endl;
+  auto v_normVt = atlas::array::make_view<double, 2>(normVt);
+
+  atlas::FieldSet normLvl = util::createFieldSet(fs,
+    std::vector<size_t>{levels}, std::vector<std::string>{"norm"});
+  auto v_normLvl = atlas::array::make_view<double, 2>(normLvl["norm"]);
+
+  for (size_t lvl0 = 0; lvl0 < nApplications; lvl0++) {
+    // assign 0 everywhere except 1.0 for the current levels
+    v_normLvl.assign(0.0);
+    for (atlas::idx_t i = 0; i < fs.size(); i++) {
+      for (size_t lvl = lvl0; lvl < levels; lvl += stride) {
+        v_normLvl(i, lvl) = 1.0;
+      }
+    }
+
+    // apply vertical diffusion
+    group.diffusion->multiplySqrtAD(normLvl, oops::Diffusion::Mode::VerticalOnly);
+    group.diffusion->multiplySqrtTL(normLvl, oops::Diffusion::Mode::VerticalOnly);
+
+    // check that each nonzero interval of the response contains a single probed level
+    if (stride < levels) {
+      int overlap = 0;
+      for (atlas::idx_t i = 0; i < fs.size(); i++) {
+        size_t probed = 0;
+        for (size_t lvl = 0; lvl < levels; lvl++) {
+          if (v_normLvl(i, lvl) != 0.0) {
+            if (lvl >= lvl0 && (lvl-lvl0) % stride == 0) probed++;
+            if (probed > 1) overlap = 1;
+          } else {
+            probed = 0;
+          }
+        }
+      }
+      geom_.comm().allReduceInPlace(overlap, eckit::mpi::max());
+      if (overlap == 1) return false;
+    }
+
+    // save the normalization coefficients for these levels
+    atlas_omp_parallel_for(atlas::idx_t i = 0; i < fs.size(); i++) {
+      for (size_t lvl = lvl0; lvl < levels; lvl += stride) {
+        if (v_normLvl(i, lvl) > 0.0) {
+          v_normVt(i, lvl) = 1.0 / sqrt(v_normLvl(i, lvl));
+        }
+      }
+    }
+  }
+  return true;
+}
+
+// --------------------------------------------------------------------------------------
+
+void Diffusion::horizontalNormalizationRandomized(const Group & group,
+                                                  const int randomizationIterations,
+                                                  atlas::Field & normHz) const {
+  const atlas::FunctionSpace & fs = geom_.functionSpace();
+  const size_t levels = normHz.shape(1);
+  auto v_normHz = atlas::array::make_view<double, 2>(normHz);
+
+  // fields that are needed to keep a running variance calculation
+  atlas::Field s = fs.createField<double>(atlas::option::levels(levels));
+  atlas::Field m = fs.createField<double>(atlas::option::levels(levels));
+  auto v_s = atlas::array::make_view<double, 2>(s);
+  auto v_m = atlas::array::make_view<double, 2>(m);
+  v_s.assign(0.0);
+  v_m.assign(0.0);
+
+  // Perform multiple iterations of calculating the variance of the diffusion operator
+  // when random vectors are supplied
+  oops::Log::info() << "  randomization iterations: " << randomizationIterations << std::endl;
+  oops::Log::info() << "  status:  0%"<< std::endl;
+  const int n10pct = std::floor(randomizationIterations/10.0);
+  for (int itr = 1; itr <= randomizationIterations; itr++) {
+    if ( itr % n10pct == 0 ) {
+      oops::Log::info() << "          " << 10*itr/n10pct << "%" << std::endl;
+    }
+
+    // generate random vector
+    atlas::FieldSet rand = util::createRandomFieldSet(geom_.comm(), fs,
+      std::vector<size_t>{levels}, std::vector<std::string>{"rand"});
+
+    // apply sqrt of horizontal diffusion
+    group.diffusion->multiplySqrtTL(rand, oops::Diffusion::Mode::HorizontalOnly);
+
+    // keep track of the stats needed for a running variance calculation
+    // (Welford 1962 algorithm)
+    const auto & v_rand = atlas::array::make_view<double, 2>(rand["rand"]);
+    double new_m;
+    for (atlas::idx_t i = 0; i < fs.size(); i++) {
+      for (size_t lvl = 0; lvl < levels; lvl++) {
+        const double m = v_m(i, lvl);
+        const double f = v_rand(i, lvl);
+        new_m = m + (f - m) / itr;
+        v_s(i, lvl) += (f - m)*(f - new_m);
+        v_m(i, lvl) = new_m;
+      }
+    }
+  }  // done with randomization iterations
+
+  // calculate final normalization coefficients
+  for (atlas::idx_t i = 0; i < fs.size(); i++) {
+    for (size_t lvl = 0; lvl < levels; lvl++) {
+      if (v_s(i, lvl) > 0.0) {
+        v_normHz(i, lvl) = 1.0 / sqrt(v_s(i, lvl) / (randomizationIterations-1));
+      }
+    }
+  }
+}
+
+// --------------------------------------------------------------------------------------
+
+void Diffusion::horizontalNormalizationProbing(
+    const Group & group,
+    const DiffusionParameters::Calibration & calibrationParams,
+    const atlas::Field & hzScales,
+    atlas::Field & normHz) const {
+  // The variance at a point is the diagonal of the horizontal diffusion C = L L^T. The points
+  // are split into colours such that points of the same colour are farther apart than the
+  // support of C. Applying C to the vector holding random signs at the points of a colour then
+  // gives the diagonal at these points, up to the residual interaction between points of the
+  // same colour, which has a zero mean thanks to the random signs. Several colours are probed
+  // in a single application by stacking them along the level dimension.
+  const atlas::FunctionSpace & fs = geom_.functionSpace();
+  const eckit::mpi::Comm & comm = geom_.comm();
+  const size_t levels = normHz.shape(1);
+  const int nSweeps = calibrationParams.probingSweeps.value();
+  const int batch = calibrationParams.probesPerApplication.value();
+  ASSERT(nSweeps > 0);
+  ASSERT(batch > 0);
+
+  // separation between points of the same colour
+  double maxScale = 0.0;
+  const auto & v_hzScales = atlas::array::make_view<double, 2>(hzScales);
+  for (atlas::idx_t i = 0; i < hzScales.shape(0); i++) {
+    for (atlas::idx_t lvl = 0; lvl < hzScales.shape(1); lvl++) {
+      maxScale = std::max(maxScale, v_hzScales(i, lvl));
+    }
+  }
+  comm.allReduceInPlace(maxScale, eckit::mpi::max());
+  const double separation = calibrationParams.probingSeparation.value()*maxScale;
+
+  // mean grid spacing, from the number of points and the area of the latitude/longitude box
+  const auto & v_lonlat = atlas::array::make_view<double, 2>(fs.lonlat());
+  const auto & v_ghost = atlas::array::make_view<int, 1>(fs.ghost());
+  size_t nPoints = 0;
+  double lonMin = std::numeric_limits<double>::max();
+  double lonMax = std::numeric_limits<double>::lowest();
+  double latMin = 90.0;
+  double latMax = -90.0;
+  for (atlas::idx_t i = 0; i < fs.size(); i++) {
+    if (v_ghost(i) == 0) {
+      ++nPoints;
+      lonMin = std::min(lonMin, v_lonlat(i, 0));
+      lonMax = std::max(lonMax, v_lonlat(i, 0));
+      latMin = std::min(latMin, v_lonlat(i, 1));
+      latMax = std::max(latMax, v_lonlat(i, 1));
+    }
+  }
+  comm.allReduceInPlace(nPoints, eckit::mpi::sum());
+  comm.allReduceInPlace(lonMin, eckit::mpi::min());
+  comm.allReduceInPlace(lonMax, eckit::mpi::max());
+  comm.allReduceInPlace(latMin, eckit::mpi::min());
+  comm.allReduceInPlace(latMax, eckit::mpi::max());
+  const double radius = atlas::util::Earth().radius();
+  const double deg2rad = M_PI/180.0;
+  const double area = radius*radius*std::min(lonMax-lonMin, 360.0)*deg2rad
+    *(std::sin(latMax*deg2rad)-std::sin(latMin*deg2rad));
+  const double dx = std::sqrt(area/static_cast<double>(std::max(nPoints, size_t(1))));
+
+  // colour of each point, from latitude bands and longitude cells of about one grid spacing,
+  // with ncPerDir cells between two cells of the same colour in each direction. The number of
+  // longitude cells of a band is a multiple of ncPerDir, so that the colours are also
+  // separated across the 0/360 degrees longitude wrap.
+  const int ncPerDir = static_cast<int>(std::ceil(separation/dx))+1;
+  const int nColours = ncPerDir*ncPerDir;
+  const double cellSize = dx/(radius*deg2rad);
+  std::vector<int> colour(fs.size());
+  for (atlas::idx_t i = 0; i < fs.size(); i++) {
+    const int iLat = static_cast<int>(std::floor((v_lonlat(i, 1)+90.0)/cellSize));
+    const double cosLat = std::max(std::cos((-90.0+(iLat+0.5)*cellSize)*deg2rad), 1.0e-6);
+    const int nLon = std::max(ncPerDir,
+      static_cast<int>(std::floor(360.0*cosLat/(cellSize*ncPerDir)))*ncPerDir);
+    const double lon = v_lonlat(i, 0)-360.0*std::floor(v_lonlat(i, 0)/360.0);
+    const int iLon = std::min(static_cast<int>(std::floor(lon*nLon/360.0)), nLon-1);
+    colour[i] = (iLat % ncPerDir)*ncPerDir+(iLon % ncPerDir);
+  }
+  const int nApplications = (nColours+batch-1)/batch;
+  oops::Log::info() << "  probing separation: " << separation << " m" << std::endl;
+  oops::Log::info() << "  mean grid spacing: " << dx << " m" << std::endl;
+  oops::Log::info() << "  colours: " << nColours << ", probes per application: " << batch
+                    << ", applications per sweep: " << nApplications << std::endl;
+
+  // probes of a batch are stacked along the level dimension for 2D scales, and
+  // put in separate fields of the same fieldset otherwise
+  const int nFields = (levels == 1) ? 1 : batch;
+  const int nStacked = (levels == 1) ? batch : 1;
+
+  // running mean of the variance estimates
+  atlas::Field var = fs.createField<double>(atlas::option::levels(levels));
+  auto v_var = atlas::array::make_view<double, 2>(var);
+  v_var.assign(0.0);
+  std::vector<double> sign(fs.size());
+  const std::uint64_t probingSeed = 7;
+  const auto & v_gidx = atlas::array::make_view<atlas::gidx_t, 1>(fs.global_index());
+
+  for (int sweep = 0; sweep < nSweeps; sweep++) {
+    // random signs attached to global indices, consistent between owned and halo points
+    for (atlas::idx_t i = 0; i < fs.size(); i++) {
+      sign[i] = util::counterBasedNormal(probingSeed, sweep, v_gidx(i)) < 0.0 ? -1.0 : 1.0;
+    }
+
+    double maxChange = 0.0;
+    for (int c0 = 0; c0 < nColours; c0 += batch) {
+      // probe vectors
+      atlas::FieldSet probes;
+      for (int jf = 0; jf < nFields; jf++) {
+        atlas::Field probe = fs.createField<double>(
+          atlas::option::levels(nStacked*levels) | atlas::option::name("probe_"
+          + std::to_string(jf)));
+        auto v_probe = atlas::array::make_view<double, 2>(probe);
+        v_probe.assign(0.0);
+        probes.add(probe);
+      }
+      for (atlas::idx_t i = 0; i < fs.size(); i++) {
+        const int k = colour[i]-c0;
+        if (k >= 0 && k < batch) {
+          auto v_probe = atlas::array::make_view<double, 2>(probes[k % nFields]);
+          for (size_t lvl = 0; lvl < levels; lvl++) {
+            v_probe(i, (k % nStacked)*levels+lvl) = sign[i];
+          }
+        }
+      }
+
+      // apply horizontal diffusion
+      group.diffusion->multiplySqrtAD(probes, oops::Diffusion::Mode::HorizontalOnly);
+      group.diffusion->multiplySqrtTL(probes, oops::Diffusion::Mode::HorizontalOnly);
+
+      // update the running mean at the probed points
+      for (atlas::idx_t i = 0; i < fs.size(); i++) {
+        const int k = colour[i]-c0;
+        if (k >= 0 && k < batch) {
+          const auto & v_probe = atlas::array::make_view<double, 2>(probes[k % nFields]);
+          for (size_t lvl = 0; lvl < levels; lvl++) {
+            const double estimate = sign[i]*v_probe(i, (k % nStacked)*levels+lvl);
+            const double newMean = v_var(i, lvl)+(estimate-v_var(i, lvl))/(sweep+1);
+            if (sweep > 0 && v_ghost(i) == 0 && newMean > 0.0) {
+              maxChange = std::max(maxChange, std::abs(newMean-v_var(i, lvl))/newMean);
+            }
+            v_var(i, lvl) = newMean;
+          }
+        }
+      }
+    }
+
+    // convergence diagnostic
+    if (sweep > 0) {
+      comm.allReduceInPlace(maxChange, eckit::mpi::max());
+      oops::Log::info() << "  sweep " << sweep+1 << ": maximum relative change of the variance: "
+                        << maxChange << std::endl;
+    }
+  }
+
+  // calculate final normalization coefficients
+  auto v_normHz = atlas::array::make_view<double, 2>(normHz);
+  for (atlas::idx_t i = 0; i < fs.size(); i++) {
+    for (size_t lvl = 0; lvl < levels; lvl++) {
+      if (v_var(i, lvl) > 0.0) {
+        v_normHz(i, lvl) = 1.0 / sqrt(v_var(i, lvl));
+      }
+    }
+  }
+
+  // optional validation against the randomization method
+  if (calibrationParams.validationTolerance.value() != boost::none) {
+    const double tolerance = *calibrationParams.validationTolerance.value();
+    atlas::Field refNorm = fs.createField<double>(atlas::option::levels(levels));
+    auto v_refNorm = atlas::array::make_view<double, 2>(refNorm);
+    v_refNorm.assign(1.0);
+    horizontalNormalizationRandomized(group, calibrationParams.normalizationIterations.value(),
+                                      refNorm);
+    double diffMax = 0.0;
+    for (atlas::idx_t i = 0; i < fs.size(); i++) {
+      if (v_ghost(i) == 0) {
+        for (size_t lvl = 0; lvl < levels; lvl++) {
+          diffMax = std::max(diffMax,
+            std::abs(v_normHz(i, lvl)-v_refNorm(i, lvl))/v_refNorm(i, lvl));
+        }
+      }
+    }
+    comm.allReduceInPlace(diffMax, eckit::mpi::max());
+    oops::Log::info() << "  validation: maximum relative difference with randomization = "
+                      << diffMax << " (tolerance = " << tolerance << ")" << std::endl;
+    if (diffMax > tolerance) {
+      throw eckit::Exception("saber::Diffusion: probed normalization validation failed",
+                             Here());
+    }
+  }
+}
+
+// --------------------------------------------------------------------------------------
+
 }  // namespace saber
@@ -64,5 +64,12 @@ class Diffusion : public saber::SaberCentralBlockBase {
     bool varDuplicated = false;
   };
   std::vector<Group> groups_;
+
+  void horizontalNormalizationRandomized(const Group &, const int,
+                                         atlas::Field &) const;
+  void horizontalNormalizationProbing(const Group &, const DiffusionParameters::Calibration &,
+                                      const atlas::Field &, atlas::Field &) const;
+  size_t verticalBandwidth(const Group &, const size_t) const;
+  bool verticalNormalization(const Group &, const size_t, atlas::Field &) const;
 };
 }  // namespace saber
@@ -51,8 +51,37 @@ class DiffusionParameters : public saber::SaberBlockParametersBase {
 
   class Calibration : public oops::Parameters {
     OOPS_CONCRETE_PARAMETERS(Calibration, oops::Parameters)
+
    public:
     oops::RequiredParameter<int> normalizationIterations {"normalization.iterations", this};
+
+    /// horizontal normalization method: "randomization" (Welford variance of randomized
+    /// vectors) or "probing" (coloured probing with random signs)
+    oops::Parameter<std::string> normalizationMethod {"normalization.method", "randomization",
+                                                      this};
+
+    /// minimum distance between probed points of the same colour, in units of the largest
+    /// horizontal Gaussian scale
+    oops::Parameter<double> probingSeparation {"normalization.probing separation", 4.0, this};
+
+    /// number of sweeps over all colours, with different random signs
+    oops::Parameter<int> probingSweeps {"normalization.probing sweeps", 1, this};
+
+    /// number of colours probed together in a single diffusion application
+    oops::Parameter<int> probesPerApplication {"normalization.probes per application", 1, this};
+
+    /// vertical normalization method: "banded" (levels whose responses do not overlap in any
+    /// column are probed together) or "brute force" (one dirac per level)
+    oops::Parameter<std::string> verticalNormalizationMethod {"normalization.vertical method",
+                                                              "banded", this};
+
+    /// compare the banded vertical normalization with the brute force one
+    oops::Parameter<bool> verticalValidation {"normalization.vertical validation", false, this};
+
+    /// if set, the probed normalization is compared to the randomized one and the calibration
+    /// fails if their maximum relative difference exceeds this tolerance
+    oops::OptionalParameter<double> validationTolerance {"normalization.validation tolerance",
+                                                         this};
     oops::RequiredParameter<std::vector<Group> > groups {"groups", this};
   };
 
@@ -14,6 +14,7 @@
 #include <algorithm>
 #include <cmath>
 #include <limits>
+#include <utility>
 #include <vector>
 
 #include "eckit/exception/Exceptions.h"
@@ -23,6 +24,8 @@
 #include "oops/util/missingValues.h"
 #include "oops/util/RandomField.h"
 
+#include "saber/util/CounterBasedRandom.h"
+
 #define ERR(e) {throw eckit::Exception(nc_strerror(e), Here());}
 
 namespace saber {
@@ -141,39 +144,94 @@ void FastLAM::randomize(oops::FieldSet3D & fset) const {
   // Create control vector
   atlas::Field cv("genericCtlVec", atlas::array::make_datatype<double>(),
     atlas::array::make_shape(ctlVecSize()));
+  auto cvView = atlas::array::make_view<double, 1>(cv);
 
-  // Sizes, sendcounts and displs
-  std::vector<int> sendcounts(comm_.size());
-  comm_.allGather(static_cast<int>(ctlVecSize()), sendcounts.begin(), sendcounts.end());
-  size_t ctlVecSizeGlb = 0;
-  for (const auto ctlVecSize : sendcounts) {
-    ctlVecSizeGlb += ctlVecSize;
-  }
-  std::vector<int> displs(comm_.size());
-  displs[0] = 0;
-  for (size_t jt = 0; jt < comm_.size()-1; ++jt) {
-    displs[jt+1] = displs[jt]+sendcounts[jt];
-  }
+  if (params_.randomGenerator.value() == "counter-based") {
+    // Each task generates its own part of the control vector. There is one random stream per
+    // member, bin, group and variable, indexed by the global index on the layer control grid,
+    // so that the random vector does not depend on the MPI decomposition.
+    size_t nVarMax = 0;
+    for (const auto & group : groups_) {
+      nVarMax = std::max(nVarMax, group.variables_.size());
+    }
+    std::vector<size_t> streams;
+    std::vector<size_t> indices;
+    streams.reserve(ctlVecSize());
+    indices.reserve(ctlVecSize());
+    std::vector<size_t> layerIndices;
+    for (size_t jBin = 0; jBin < weight_.size(); ++jBin) {
+      for (size_t jg = 0; jg < groups_.size(); ++jg) {
+        // Number of control vector blocks for this group
+        size_t nBlocks = 0;
+        if (params_.strategy.value() == "univariate") {
+          nBlocks = groups_[jg].variables_.size();
+        } else if (params_.strategy.value() == "duplicated") {
+          nBlocks = 1;
+        } else if (params_.strategy.value() == "crossed") {
+          nBlocks = (jg == 0) ? 1 : 0;
+        }
+        if (nBlocks > 0) {
+          data_[jg][jBin]->ctlVecIndices(layerIndices);
+        }
+        for (size_t jf = 0; jf < nBlocks; ++jf) {
+          const size_t stream = ((randomizeCount_*weight_.size()+jBin)*groups_.size()+jg)
+            *nVarMax+jf;
+          for (const auto & layerIndex : layerIndices) {
+            streams.push_back(stream);
+            indices.push_back(layerIndex);
+          }
+        }
+      }
+    }
+    ASSERT(indices.size() == ctlVecSize());
 
-  // Generate global random vector
-  std::vector<double> rand_vec_glb;
-  if (comm_.rank() == 0) {
-    util::NormalDistributionField dist(ctlVecSizeGlb, 0.0, 1.0);
-    rand_vec_glb.resize(ctlVecSizeGlb);
-    for (size_t i = 0; i < ctlVecSizeGlb; ++i) {
-      rand_vec_glb[i] = dist[i];
+    // Fill control vector
+    for (size_t jcv = 0; jcv < ctlVecSize(); ++jcv) {
+      cvView(jcv) = util::counterBasedNormal(randomSeed_, streams[jcv], indices[jcv]);
+    }
+
+    if (params_.randomizationTest.value()) {
+      // Check that the tasks generate disjoint parts of the same global random vector
+      testRandomization(streams, indices);
+    }
+    ++randomizeCount_;
+  } else if (params_.randomGenerator.value() == "global") {
+    // Sizes, sendcounts and displs
+    std::vector<int> sendcounts(comm_.size());
+    comm_.allGather(static_cast<int>(ctlVecSize()), sendcounts.begin(), sendcounts.end());
+    size_t ctlVecSizeGlb = 0;
+    for (const auto ctlVecSize : sendcounts) {
+      ctlVecSizeGlb += ctlVecSize;
+    }
+    std::vector<int> displs(comm_.size());
+    displs[0] = 0;
+    for (size_t jt = 0; jt < comm_.size()-1; ++jt) {
+      displs[jt+1] = displs[jt]+sendcounts[jt];
+    }
+
+    // Generate global random vector
+    std::vector<double> rand_vec_glb;
+    if (comm_.rank() == 0) {
+      util::NormalDistributionField dist(ctlVecSizeGlb, 0.0, 1.0);
+      rand_vec_glb.resize(ctlVecSizeGlb);
+      for (size_t i = 0; i < ctlVecSizeGlb; ++i) {
+        rand_vec_glb[i] = dist[i];
+      }
     }
-  }
 
-  // Scatter random vector
-  std::vector<double> rand_vec(ctlVecSize());
-  comm_.scatterv(rand_vec_glb.begin(), rand_vec_glb.end(), sendcounts, displs,
-    rand_vec.begin(), rand_vec.end(), 0);
+    // Scatter random vector
+    std::vector<double> rand_vec(ctlVecSize());
+    comm_.scatterv(rand_vec_glb.begin(), rand_vec_glb.end(), sendcounts, displs,
+      rand_vec.begin(), rand_vec.end(), 0);
 
-  // Fill control vector
-  auto cvView = atlas::array::make_view<double, 1>(cv);
-  for (size_t jcv = 0; jcv < ctlVecSize(); ++jcv) {
-    cvView(jcv) = rand_vec[jcv];
+    // Fill control vector
+    for (size_t jcv = 0; jcv < ctlVecSize(); ++jcv) {
+      cvView(jcv) = rand_vec[jcv];
+    }
+  } else {
+    // Wrong random number generator
+    throw eckit::UserError("wrong random number generator: " + params_.randomGenerator.value(),
+      Here());
   }
 
   // Square-root multiplication
@@ -204,6 +262,38 @@ void FastLAM::multiply(oops::FieldSet3D & fset) const {
 
 // -----------------------------------------------------------------------------
 
+void FastLAM::multiplyBatch(std::vector<oops::FieldSet3D> & fsets) const {
+  oops::Log::trace() << classname() << "::multiplyBatch starting" << std::endl;
+
+  // FieldSets of the batch
+  std::vector<atlas::FieldSet> fieldSets;
+  for (auto & fset : fsets) {
+    fieldSets.push_back(fset.fieldSet());
+  }
+
+  // Create control vector for all the batch members
+  atlas::Field cv("genericCtlVec", atlas::array::make_datatype<double>(),
+    atlas::array::make_shape(fsets.size()*ctlVecSize()));
+  const size_t index = 0;
+
+  // Square-root multiplication, adjoint, with one interpolation exchange per layer for all the
+  // batch members
+  multiplySqrtADBatch(fieldSets, cv, index);
+
+  // Square-root multiplication
+  multiplySqrtBatch(cv, fieldSets, index);
+
+  // Release the scratch fields of the extra batch members, only the first slot is kept for
+  // single-member applications
+  if (scratch_.size() > 1) {
+    scratch_.resize(1);
+  }
+
+  oops::Log::trace() << classname() << "::multiplyBatch done" << std::endl;
+}
+
+// -----------------------------------------------------------------------------
+
 size_t FastLAM::ctlVecSize() const {
   oops::Log::trace() << classname() << "::ctlVecSize starting" << std::endl;
 
@@ -243,167 +333,171 @@ void FastLAM::multiplySqrt(const atlas::Field & cv,
                            const size_t & offset) const {
   oops::Log::trace() << classname() << "::multiplySqrt starting" << std::endl;
 
+  // Batch of one FieldSet
+  std::vector<atlas::FieldSet> fsets({fset.fieldSet()});
+  multiplySqrtBatch(cv, fsets, offset);
+
+  oops::Log::trace() << classname() << "::multiplySqrt done" << std::endl;
+}
+
+// -----------------------------------------------------------------------------
+
+void FastLAM::multiplySqrtAD(const oops::FieldSet3D & fset,
+                             atlas::Field & cv,
+                             const size_t & offset) const {
+  oops::Log::trace() << classname() << "::multiplySqrtAD starting" << std::endl;
+
+  // Batch of one FieldSet
+  const std::vector<atlas::FieldSet> fsets({fset.fieldSet()});
+  multiplySqrtADBatch(fsets, cv, offset);
+
+  oops::Log::trace() << classname() << "::multiplySqrtAD done" << std::endl;
+}
+
+// -----------------------------------------------------------------------------
+
+void FastLAM::multiplySqrtBatch(const atlas::Field & cv,
+                                std::vector<atlas::FieldSet> & fsets,
+                                const size_t & offset) const {
+  oops::Log::trace() << classname() << "::multiplySqrtBatch starting" << std::endl;
+
+  // Batch size
+  const size_t nb = fsets.size();
+
   // Ghost points
   const auto ghostView = atlas::array::make_view<int, 1>(gdata_.functionSpace().ghost());
 
-  // Save input FieldSet
-  oops::FieldSet3D fsetIn(fset);
-  fset.zero();
+  // Initialize output, bin contributions are accumulated in place
+  for (auto & fset : fsets) {
+    for (auto & field : fset) {
+      auto fieldView = atlas::array::make_view<double, 2>(field);
+      fieldView.assign(0.0);
+    }
+  }
 
   // Initialize control vector index
   int index = offset;
 
   // Loop over bins
   for (size_t jBin = 0; jBin < weight_.size(); ++jBin) {
-    // Copy input FieldSet
-    oops::FieldSet3D fsetBin(fsetIn);
-
     if (params_.strategy.value() == "univariate") {
       // Univariate strategy
       for (size_t jg = 0; jg < groups_.size(); ++jg) {
-        // Loop over variables
-        for (const auto & var : groups_[jg].variables_) {
-          // Variable properties
-          const size_t varNz0 = activeVars_[var].getLevels();
-          const size_t k0Offset = getK0Offset(var);
-
-          // Layer multiplication
-          atlas::Field binField = fsetBin[var];
-          data_[jg][jBin]->multiplySqrt(cv, binField, index);
-
-          // Update control vector index
-          index += data_[jg][jBin]->ctlVecSize();
-
-          // Apply weight square-root and normalization
-          auto binView = atlas::array::make_view<double, 2>(binField);
-          const atlas::Field wgtSqrtField = (*weight_[jBin])[groups_[jg].name_];
-          const auto wgtSqrtView = atlas::array::make_view<double, 2>(wgtSqrtField);
-          const atlas::Field normField = (*normalization_[jBin])[groups_[jg].name_];
-          const auto normView = atlas::array::make_view<double, 2>(normField);
-          for (size_t jnode0 = 0; jnode0 < nodes0_; ++jnode0) {
-            if (ghostView(jnode0) == 0) {
-              for (size_t k0 = 0; k0 < varNz0; ++k0) {
-                binView(jnode0, k0) *= wgtSqrtView(jnode0, k0Offset+k0)
-                  *normView(jnode0, k0Offset+k0);
-              }
-            }
+        // Layer multiplication, all variables of the group and all batch members at once, into
+        // scratch fields
+        std::vector<atlas::Field> binFields;
+        for (size_t jb = 0; jb < nb; ++jb) {
+          for (const auto & var : groups_[jg].variables_) {
+            binFields.push_back(getScratchField(var, jb, activeVars_[var].getLevels()));
           }
         }
-      }
-    } else if (params_.strategy.value() == "duplicated") {
-      // Duplicated strategy
-      for (size_t jg = 0; jg < groups_.size(); ++jg) {
-        // Create group field
-        atlas::Field grpField = gdata_.functionSpace().createField<double>(
-          atlas::option::name(groups_[jg].name_) | atlas::option::levels(groups_[jg].nz0_));
-        auto grpView = atlas::array::make_view<double, 2>(grpField);
-
-        // Layer multiplication
-        data_[jg][jBin]->multiplySqrt(cv, grpField, index);
+        data_[jg][jBin]->multiplySqrt(cv, binFields, index);
 
         // Update control vector index
-        index += data_[jg][jBin]->ctlVecSize();
+        index += nb*data_[jg][jBin]->ctlVecSize()*groups_[jg].variables_.size();
 
-        // Apply weight square-root and normalization
+        // Weight square-root and normalization
         const atlas::Field wgtSqrtField = (*weight_[jBin])[groups_[jg].name_];
         const auto wgtSqrtView = atlas::array::make_view<double, 2>(wgtSqrtField);
         const atlas::Field normField = (*normalization_[jBin])[groups_[jg].name_];
         const auto normView = atlas::array::make_view<double, 2>(normField);
-        for (size_t jnode0 = 0; jnode0 < nodes0_; ++jnode0) {
-          if (ghostView(jnode0) == 0) {
-            for (size_t k0 = 0; k0 < groups_[jg].nz0_; ++k0) {
-              grpView(jnode0, k0) *= wgtSqrtView(jnode0, k0)*normView(jnode0, k0);
-            }
-          }
-        }
-
-        // Copy result on all variables of the group
-        for (const auto & var : groups_[jg].variables_) {
-          // Variable properties
-          const size_t varNz0 = activeVars_[var].getLevels();
-          const size_t k0Offset = getK0Offset(var);
 
-          // Copy group field
-          atlas::Field binField = fsetBin[var];
-          auto binView = atlas::array::make_view<double, 2>(binField);
-          for (size_t jnode0 = 0; jnode0 < nodes0_; ++jnode0) {
-            if (ghostView(jnode0) == 0) {
-              for (size_t k0 = 0; k0 < varNz0; ++k0) {
-                binView(jnode0, k0) = grpView(jnode0, k0Offset+k0);
+        // Loop over batch members and variables
+        for (size_t jb = 0; jb < nb; ++jb) {
+          for (size_t jf = 0; jf < groups_[jg].variables_.size(); ++jf) {
+            // Variable properties
+            const std::string & var = groups_[jg].variables_[jf];
+            const size_t varNz0 = activeVars_[var].getLevels();
+            const size_t k0Offset = getK0Offset(var);
+
+            // Apply weight square-root and normalization, and add component
+            const auto binView = atlas::array::make_view<double, 2>(
+              binFields[jb*groups_[jg].variables_.size()+jf]);
+            auto fieldView = atlas::array::make_view<double, 2>(fsets[jb][var]);
+            for (size_t jnode0 = 0; jnode0 < nodes0_; ++jnode0) {
+              if (ghostView(jnode0) == 0) {
+                for (size_t k0 = 0; k0 < varNz0; ++k0) {
+                  fieldView(jnode0, k0) += binView(jnode0, k0)*(wgtSqrtView(jnode0, k0Offset+k0)
+                    *normView(jnode0, k0Offset+k0));
+                }
               }
             }
           }
         }
       }
-    } else if (params_.strategy.value() == "crossed") {
+    } else if ((params_.strategy.value() == "duplicated")
+      || (params_.strategy.value() == "crossed")) {
+      // Duplicated or crossed strategy
       for (size_t jg = 0; jg < groups_.size(); ++jg) {
-        // Create group field
-        atlas::Field grpField = gdata_.functionSpace().createField<double>(
-          atlas::option::name(groups_[jg].name_) | atlas::option::levels(groups_[jg].nz0_));
-        auto grpView = atlas::array::make_view<double, 2>(grpField);
+        // Group scratch fields, one per batch member
+        std::vector<atlas::Field> grpFields;
+        for (size_t jb = 0; jb < nb; ++jb) {
+          grpFields.push_back(getScratchField("group " + groups_[jg].name_, jb,
+                                              groups_[jg].nz0_));
+        }
+
+        // Layer square-root multiplication, all batch members at once
+        data_[jg][jBin]->multiplySqrt(cv, grpFields, index);
 
-        // Layer square-root multiplication
-        data_[jg][jBin]->multiplySqrt(cv, grpField, index);
+        if (params_.strategy.value() == "duplicated") {
+          // Update control vector index
+          index += nb*data_[jg][jBin]->ctlVecSize();
+        }
 
-        // Apply weight square-root and normalization
+        // Weight square-root and normalization
         const atlas::Field wgtSqrtField = (*weight_[jBin])[groups_[jg].name_];
         const auto wgtSqrtView = atlas::array::make_view<double, 2>(wgtSqrtField);
         const atlas::Field normField = (*normalization_[jBin])[groups_[jg].name_];
         const auto normView = atlas::array::make_view<double, 2>(normField);
-        for (size_t jnode0 = 0; jnode0 < nodes0_; ++jnode0) {
-          if (ghostView(jnode0) == 0) {
-            for (size_t k0 = 0; k0 < groups_[jg].nz0_; ++k0) {
-              grpView(jnode0, k0) *= wgtSqrtView(jnode0, k0)*normView(jnode0, k0);
-            }
-          }
-        }
-
-        // Copy result on all variables of the group
-        for (const auto & var : groups_[jg].variables_) {
-          // Variable properties
-          const size_t varNz0 = activeVars_[var].getLevels();
-          const size_t k0Offset = getK0Offset(var);
 
-          // Copy group field
-          atlas::Field binField = fsetBin[var];
-          auto binView = atlas::array::make_view<double, 2>(binField);
-          for (size_t jnode0 = 0; jnode0 < nodes0_; ++jnode0) {
-            if (ghostView(jnode0) == 0) {
-              for (size_t k0 = 0; k0 < varNz0; ++k0) {
-                binView(jnode0, k0) = grpView(jnode0, k0Offset+k0);
+        // Add weighted result on all variables of the group
+        for (size_t jb = 0; jb < nb; ++jb) {
+          const auto grpView = atlas::array::make_view<double, 2>(grpFields[jb]);
+          for (const auto & var : groups_[jg].variables_) {
+            // Variable properties
+            const size_t varNz0 = activeVars_[var].getLevels();
+            const size_t k0Offset = getK0Offset(var);
+
+            // Apply weight square-root and normalization, and add component
+            auto fieldView = atlas::array::make_view<double, 2>(fsets[jb][var]);
+            for (size_t jnode0 = 0; jnode0 < nodes0_; ++jnode0) {
+              if (ghostView(jnode0) == 0) {
+                for (size_t k0 = 0; k0 < varNz0; ++k0) {
+                  fieldView(jnode0, k0) += grpView(jnode0, k0Offset+k0)
+                    *(wgtSqrtView(jnode0, k0Offset+k0)*normView(jnode0, k0Offset+k0));
+                }
               }
             }
           }
         }
       }
 
-      // Update control vector index
-      index += data_[0][jBin]->ctlVecSize();
+      if (params_.strategy.value() == "crossed") {
+        // Update control vector index
+        index += nb*data_[0][jBin]->ctlVecSize();
+      }
     } else {
       // Wrong multivariate strategy
       throw eckit::UserError("wrong multivariate strategy: " + params_.strategy.value(), Here());
     }
-
-    // Add component
-    fset += fsetBin;
   }
 
-  oops::Log::trace() << classname() << "::multiplySqrt done" << std::endl;
+  oops::Log::trace() << classname() << "::multiplySqrtBatch done" << std::endl;
 }
 
 // -----------------------------------------------------------------------------
 
-void FastLAM::multiplySqrtAD(const oops::FieldSet3D & fset,
-                             atlas::Field & cv,
-                             const size_t & offset) const {
-  oops::Log::trace() << classname() << "::multiplySqrtAD starting" << std::endl;
+void FastLAM::multiplySqrtADBatch(const std::vector<atlas::FieldSet> & fsets,
+                                  atlas::Field & cv,
+                                  const size_t & offset) const {
+  oops::Log::trace() << classname() << "::multiplySqrtADBatch starting" << std::endl;
+
+  // Batch size
+  const size_t nb = fsets.size();
 
   // Ghost points
   const auto ghostView = atlas::array::make_view<int, 1>(gdata_.functionSpace().ghost());
 
-  // Save input FieldSet
-  oops::FieldSet3D fsetIn(fset);
-
   if (params_.strategy.value() == "crossed") {
     // Initialize control vector
     auto cvView = atlas::array::make_view<double, 1>(cv);
@@ -415,152 +509,129 @@ void FastLAM::multiplySqrtAD(const oops::FieldSet3D & fset,
 
   // Loop over bins
   for (size_t jBin = 0; jBin < weight_.size(); ++jBin) {
-    // Copy input FieldSet
-    oops::FieldSet3D fsetBin(fsetIn);
-
     if (params_.strategy.value() == "univariate") {
       // Univariate strategy
       for (size_t jg = 0; jg < groups_.size(); ++jg) {
-        // Loop over variables
-        for (const auto & var : groups_[jg].variables_) {
-          // Variable properties
-          const size_t varNz0 = activeVars_[var].getLevels();
-          const size_t k0Offset = getK0Offset(var);
+        // Weight square-root and normalization
+        const atlas::Field wgtSqrtField = (*weight_[jBin])[groups_[jg].name_];
+        const auto wgtSqrtView = atlas::array::make_view<double, 2>(wgtSqrtField);
+        const atlas::Field normField = (*normalization_[jBin])[groups_[jg].name_];
+        const auto normView = atlas::array::make_view<double, 2>(normField);
 
-          // Apply weight square-root and normalization
-          atlas::Field binField = fsetBin[var];
-          auto binView = atlas::array::make_view<double, 2>(binField);
-          const atlas::Field wgtSqrtField = (*weight_[jBin])[groups_[jg].name_];
-          const auto wgtSqrtView = atlas::array::make_view<double, 2>(wgtSqrtField);
-          const atlas::Field normField = (*normalization_[jBin])[groups_[jg].name_];
-          const auto normView = atlas::array::make_view<double, 2>(normField);
-          for (size_t jnode0 = 0; jnode0 < nodes0_; ++jnode0) {
-            if (ghostView(jnode0) == 0) {
-              for (size_t k0 = 0; k0 < varNz0; ++k0) {
-                binView(jnode0, k0) *= wgtSqrtView(jnode0, k0Offset+k0)
-                  *normView(jnode0, k0Offset+k0);
+        // Loop over batch members and variables
+        std::vector<atlas::Field> binFields;
+        for (size_t jb = 0; jb < nb; ++jb) {
+          for (const auto & var : groups_[jg].variables_) {
+            // Variable properties
+            const size_t varNz0 = activeVars_[var].getLevels();
+            const size_t k0Offset = getK0Offset(var);
+
+            // Apply weight square-root and normalization, from input to scratch field
+            atlas::Field binField = getScratchField(var, jb, varNz0);
+            auto binView = atlas::array::make_view<double, 2>(binField);
+            const auto fieldView = atlas::array::make_view<double, 2>(fsets[jb].field(var));
+            for (size_t jnode0 = 0; jnode0 < nodes0_; ++jnode0) {
+              if (ghostView(jnode0) == 0) {
+                for (size_t k0 = 0; k0 < varNz0; ++k0) {
+                  binView(jnode0, k0) = fieldView(jnode0, k0)*(wgtSqrtView(jnode0, k0Offset+k0)
+                    *normView(jnode0, k0Offset+k0));
+                }
               }
             }
+            binFields.push_back(binField);
           }
+        }
 
-          // Layer multiplication
-          data_[jg][jBin]->multiplySqrtTrans(binField, cv, index);
+        // Layer multiplication, all variables of the group and all batch members at once
+        data_[jg][jBin]->multiplySqrtTrans(binFields, cv, index);
 
-          // Update control vector index
-          index += data_[jg][jBin]->ctlVecSize();
-        }
+        // Update control vector index
+        index += nb*data_[jg][jBin]->ctlVecSize()*groups_[jg].variables_.size();
+      }
+    } else if ((params_.strategy.value() == "duplicated")
+      || (params_.strategy.value() == "crossed")) {
+      // Duplicated or crossed strategy
+      atlas::Field cvBin;
+      if (params_.strategy.value() == "crossed") {
+        // Temporary control vector, shared by all groups of the bin
+        cvBin = atlas::Field("genericCtlVecBin", atlas::array::make_datatype<double>(),
+          atlas::array::make_shape(nb*data_[0][jBin]->ctlVecSize()));
       }
-    } else if (params_.strategy.value() == "duplicated") {
-      // Duplicated strategy
-      for (size_t jg = 0; jg < groups_.size(); ++jg) {
-        // Create group field
-        atlas::Field grpField = gdata_.functionSpace().createField<double>(
-          atlas::option::name(groups_[jg].name_) | atlas::option::levels(groups_[jg].nz0_));
-        auto grpView = atlas::array::make_view<double, 2>(grpField);
-        grpView.assign(0.0);
-
-        // Sum all variables of the group
-        for (const auto & var : groups_[jg].variables_) {
-          // Variable properties
-          const size_t varNz0 = activeVars_[var].getLevels();
-          const size_t k0Offset = getK0Offset(var);
-
-          // Add variable field
-          const atlas::Field binField = fsetBin[var];
-          const auto binView = atlas::array::make_view<double, 2>(binField);
-          for (size_t jnode0 = 0; jnode0 < nodes0_; ++jnode0) {
-            if (ghostView(jnode0) == 0) {
-              for (size_t k0 = 0; k0 < varNz0; ++k0) {
-                grpView(jnode0, k0Offset+k0) += binView(jnode0, k0);
-              }
-            }
-          }
-        }
 
-        // Apply weight square-root and normalization
+      for (size_t jg = 0; jg < groups_.size(); ++jg) {
+        // Weight square-root and normalization
         const atlas::Field wgtSqrtField = (*weight_[jBin])[groups_[jg].name_];
         const auto wgtSqrtView = atlas::array::make_view<double, 2>(wgtSqrtField);
         const atlas::Field normField = (*normalization_[jBin])[groups_[jg].name_];
         const auto normView = atlas::array::make_view<double, 2>(normField);
-        for (size_t jnode0 = 0; jnode0 < nodes0_; ++jnode0) {
-          if (ghostView(jnode0) == 0) {
-            for (size_t k0 = 0; k0 < groups_[jg].nz0_; ++k0) {
-              grpView(jnode0, k0) *= wgtSqrtView(jnode0, k0)*normView(jnode0, k0);
+
+        // Group scratch fields, one per batch member
+        std::vector<atlas::Field> grpFields;
+        for (size_t jb = 0; jb < nb; ++jb) {
+          atlas::Field grpField = getScratchField("group " + groups_[jg].name_, jb,
+                                                  groups_[jg].nz0_);
+          auto grpView = atlas::array::make_view<double, 2>(grpField);
+          grpView.assign(0.0);
+
+          // Sum all variables of the group
+          for (const auto & var : groups_[jg].variables_) {
+            // Variable properties
+            const size_t varNz0 = activeVars_[var].getLevels();
+            const size_t k0Offset = getK0Offset(var);
+
+            // Add variable field
+            const auto fieldView = atlas::array::make_view<double, 2>(fsets[jb].field(var));
+            for (size_t jnode0 = 0; jnode0 < nodes0_; ++jnode0) {
+              if (ghostView(jnode0) == 0) {
+                for (size_t k0 = 0; k0 < varNz0; ++k0) {
+                  grpView(jnode0, k0Offset+k0) += fieldView(jnode0, k0);
+                }
+              }
             }
           }
-        }
-
-        // Layer multiplication
-        data_[jg][jBin]->multiplySqrtTrans(grpField, cv, index);
 
-        // Update control vector index
-        index += data_[jg][jBin]->ctlVecSize();
-      }
-    } else if (params_.strategy.value() == "crossed") {
-      // Crossed strategy
-      for (size_t jg = 0; jg < groups_.size(); ++jg) {
-        // Initialize temporary control vector
-        atlas::Field cvBin("genericCtlVecBin", atlas::array::make_datatype<double>(),
-          atlas::array::make_shape(data_[jg][jBin]->ctlVecSize()));
-        auto cvBinView = atlas::array::make_view<double, 1>(cvBin);
-        ASSERT(data_[jg][jBin]->ctlVecSize() == data_[0][jBin]->ctlVecSize());
-
-        // Create group field
-        atlas::Field grpField = gdata_.functionSpace().createField<double>(
-          atlas::option::name(groups_[jg].name_) | atlas::option::levels(groups_[jg].nz0_));
-        auto grpView = atlas::array::make_view<double, 2>(grpField);
-        grpView.assign(0.0);
-
-        // Sum all variables of the group
-        for (const auto & var : groups_[jg].variables_) {
-          // Variable properties
-          const size_t varNz0 = activeVars_[var].getLevels();
-          const size_t k0Offset = getK0Offset(var);
-
-          // Add variable field
-          const atlas::Field binField = fsetBin[var];
-          const auto binView = atlas::array::make_view<double, 2>(binField);
+          // Apply weight square-root and normalization
           for (size_t jnode0 = 0; jnode0 < nodes0_; ++jnode0) {
             if (ghostView(jnode0) == 0) {
-              for (size_t k0 = 0; k0 < varNz0; ++k0) {
-                grpView(jnode0, k0Offset+k0) += binView(jnode0, k0);
+              for (size_t k0 = 0; k0 < groups_[jg].nz0_; ++k0) {
+                grpView(jnode0, k0) *= wgtSqrtView(jnode0, k0)*normView(jnode0, k0);
               }
             }
           }
+          grpFields.push_back(grpField);
         }
 
-        // Apply weight square-root and normalization
-        const atlas::Field wgtSqrtField = (*weight_[jBin])[groups_[jg].name_];
-        const auto wgtSqrtView = atlas::array::make_view<double, 2>(wgtSqrtField);
-        const atlas::Field normField = (*normalization_[jBin])[groups_[jg].name_];
-        const auto normView = atlas::array::make_view<double, 2>(normField);
-        for (size_t jnode0 = 0; jnode0 < nodes0_; ++jnode0) {
-          if (ghostView(jnode0) == 0) {
-            for (size_t k0 = 0; k0 < groups_[jg].nz0_; ++k0) {
-              grpView(jnode0, k0) *= wgtSqrtView(jnode0, k0)*normView(jnode0, k0);
-            }
-          }
-        }
+        if (params_.strategy.value() == "duplicated") {
+          // Layer multiplication, all batch members at once
+          data_[jg][jBin]->multiplySqrtTrans(grpFields, cv, index);
 
-        // Layer square-root multiplication, adjoint
-        data_[jg][jBin]->multiplySqrtTrans(grpField, cvBin, 0);
+          // Update control vector index
+          index += nb*data_[jg][jBin]->ctlVecSize();
+        } else {
+          // Layer square-root multiplication, adjoint, all batch members at once
+          ASSERT(data_[jg][jBin]->ctlVecSize() == data_[0][jBin]->ctlVecSize());
+          data_[jg][jBin]->multiplySqrtTrans(grpFields, cvBin, 0);
 
-        // Add contribution
-        auto cvView = atlas::array::make_view<double, 1>(cv);
-        for (size_t jj = 0; jj < data_[jg][jBin]->ctlVecSize(); ++jj) {
-          cvView(index+jj) += cvBinView(jj);
+          // Add contribution
+          const auto cvBinView = atlas::array::make_view<double, 1>(cvBin);
+          auto cvView = atlas::array::make_view<double, 1>(cv);
+          for (size_t jj = 0; jj < nb*data_[jg][jBin]->ctlVecSize(); ++jj) {
+            cvView(index+jj) += cvBinView(jj);
+          }
         }
       }
 
-      // Update control vector index
-      index += data_[0][jBin]->ctlVecSize();
+      if (params_.strategy.value() == "crossed") {
+        // Update control vector index
+        index += nb*data_[0][jBin]->ctlVecSize();
+      }
     } else {
       // Wrong multivariate strategy
       throw eckit::UserError("wrong multivariate strategy: " + params_.strategy.value(), Here());
     }
   }
 
-  oops::Log::trace() << classname() << "::multiplySqrtAD done" << std::endl;
+  oops::Log::trace() << classname() << "::multiplySqrtADBatch done" << std::endl;
 }
 
 // -----------------------------------------------------------------------------
@@ -1505,6 +1576,77 @@ void FastLAM::setupReductionFactors() {
 
 // -----------------------------------------------------------------------------
 
+void FastLAM::testRandomization(const std::vector<size_t> & streams,
+                                const std::vector<size_t> & indices) const {
+  oops::Log::trace() << classname() << "::testRandomization starting" << std::endl;
+
+  // Gather random stream keys on root task
+  std::vector<int> recvcounts(comm_.size());
+  comm_.gather(static_cast<int>(2*indices.size()), recvcounts, 0);
+  std::vector<int> displs(comm_.size(), 0);
+  for (size_t jt = 0; jt < comm_.size()-1; ++jt) {
+    displs[jt+1] = displs[jt]+recvcounts[jt];
+  }
+  std::vector<size_t> keys;
+  keys.reserve(2*indices.size());
+  for (size_t jcv = 0; jcv < indices.size(); ++jcv) {
+    keys.push_back(streams[jcv]);
+    keys.push_back(indices[jcv]);
+  }
+  std::vector<size_t> keysGlb;
+  if (comm_.rank() == 0) {
+    keysGlb.resize(displs[comm_.size()-1]+recvcounts[comm_.size()-1]);
+  }
+  comm_.gatherv(keys, keysGlb, recvcounts, displs, 0);
+
+  // Each (stream, index) pair should be generated by exactly one task
+  int nDuplicates = 0;
+  if (comm_.rank() == 0) {
+    std::vector<std::pair<size_t, size_t>> pairs;
+    pairs.reserve(keysGlb.size()/2);
+    for (size_t jj = 0; jj < keysGlb.size()/2; ++jj) {
+      pairs.push_back(std::make_pair(keysGlb[2*jj], keysGlb[2*jj+1]));
+    }
+    std::sort(pairs.begin(), pairs.end());
+    for (size_t jj = 1; jj < pairs.size(); ++jj) {
+      if (pairs[jj] == pairs[jj-1]) ++nDuplicates;
+    }
+  }
+  comm_.broadcast(nDuplicates, 0);
+
+  // Global random vector size should not depend on the decomposition, compare with the sum of
+  // the layer control grid sizes
+  size_t ctlVecSizeGlb = indices.size();
+  comm_.allReduceInPlace(ctlVecSizeGlb, eckit::mpi::sum());
+  size_t ctlVecSizeRef = 0;
+  std::vector<size_t> layerIndices;
+  for (size_t jBin = 0; jBin < weight_.size(); ++jBin) {
+    for (size_t jg = 0; jg < groups_.size(); ++jg) {
+      data_[jg][jBin]->ctlVecIndices(layerIndices);
+      size_t layerSizeGlb = layerIndices.size();
+      comm_.allReduceInPlace(layerSizeGlb, eckit::mpi::sum());
+      if (params_.strategy.value() == "univariate") {
+        ctlVecSizeRef += layerSizeGlb*groups_[jg].variables_.size();
+      } else if ((params_.strategy.value() == "duplicated") || (jg == 0)) {
+        ctlVecSizeRef += layerSizeGlb;
+      }
+    }
+  }
+
+  oops::Log::test() << "    FastLAM randomization reproducibility test";
+  if ((nDuplicates == 0) && (ctlVecSizeGlb == ctlVecSizeRef)) {
+    oops::Log::test() << " passed" << std::endl;
+  } else {
+    oops::Log::test() << " failed" << std::endl;
+    throw eckit::Exception("randomization reproducibility test failed for block FastLAM",
+      Here());
+  }
+
+  oops::Log::trace() << classname() << "::testRandomization done" << std::endl;
+}
+
+// -----------------------------------------------------------------------------
+
 size_t FastLAM::getGroupIndex(const std::string & var) const {
   oops::Log::trace() << classname() << "::getGroupIndex starting" << std::endl;
 
@@ -1551,6 +1693,27 @@ size_t FastLAM::getK0Offset(const std::string & var) const {
 
 // -----------------------------------------------------------------------------
 
+atlas::Field FastLAM::getScratchField(const std::string & name,
+                                     const size_t & jb,
+                                     const size_t & nz0) const {
+  oops::Log::trace() << classname() << "::getScratchField starting" << std::endl;
+
+  // Create scratch field on first use
+  if (scratch_.size() <= jb) {
+    scratch_.resize(jb+1);
+  }
+  if (!scratch_[jb].has(name)) {
+    scratch_[jb].add(gdata_.functionSpace().createField<double>(atlas::option::name(name)
+      | atlas::option::levels(nz0)));
+  }
+  ASSERT(static_cast<size_t>(scratch_[jb][name].shape(1)) == nz0);
+
+  oops::Log::trace() << classname() << "::getScratchField done" << std::endl;
+  return scratch_[jb][name];
+}
+
+// -----------------------------------------------------------------------------
+
 eckit::LocalConfiguration FastLAM::getFileConf(const eckit::mpi::Comm & comm,
                                                const eckit::Configuration & conf) const {
   oops::Log::trace() << classname() << "::getFileConf starting" << std::endl;
@@ -60,6 +60,7 @@ class FastLAM : public SaberCentralBlockBase {
 
   void randomize(oops::FieldSet3D &) const override;
   void multiply(oops::FieldSet3D &) const override;
+  void multiplyBatch(std::vector<oops::FieldSet3D> &) const override;
 
   size_t ctlVecSize() const override;
   void multiplySqrt(const atlas::Field &,
@@ -120,6 +121,13 @@ class FastLAM : public SaberCentralBlockBase {
   size_t ny0_;
   size_t nodes0_;
 
+  // Scratch fields for the bin application, one set per batch member, reused across calls
+  mutable std::vector<atlas::FieldSet> scratch_;
+
+  // Randomization
+  const size_t randomSeed_ = 7;  // For reproducibility
+  mutable size_t randomizeCount_ = 0;
+
   // Setup length-scales
   void setupLengthScales();
 
@@ -135,9 +143,24 @@ class FastLAM : public SaberCentralBlockBase {
   // Setup reduction factors
   void setupReductionFactors();
 
+  // Test randomization reproducibility
+  void testRandomization(const std::vector<size_t> &,
+                         const std::vector<size_t> &) const;
+
+  // Square-root multiplication and adjoint for a batch of FieldSets
+  void multiplySqrtBatch(const atlas::Field &,
+                         std::vector<atlas::FieldSet> &,
+                         const size_t &) const;
+  void multiplySqrtADBatch(const std::vector<atlas::FieldSet> &,
+                           atlas::Field &,
+                           const size_t &) const;
+
   // Utilities
   size_t getGroupIndex(const std::string &) const;
   size_t getK0Offset(const std::string &) const;
+  atlas::Field getScratchField(const std::string &,
+                               const size_t &,
+                               const size_t &) const;
   eckit::LocalConfiguration getFileConf(const eckit::mpi::Comm &,
                                         const eckit::Configuration &) const;
   void print(std::ostream &) const override;
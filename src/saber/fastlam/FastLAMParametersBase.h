@@ -79,6 +79,16 @@ class FastLAMParametersBase : public oops::Parameters {
   // Parallelization (rows-columns or halo)
   oops::Parameter<std::string> parallelization{"parallelization", "rows-columns", this};
 
+  // Number of level chunks to pipeline transposes and convolutions (rows-columns parallelization)
+  oops::Parameter<size_t> transposeChunks{"transpose level chunks", 1, this};
+
+  // FFTW wisdom file, imported before planning and updated after (spectral parallelization)
+  oops::OptionalParameter<std::string> fftwWisdomFile{"fftw wisdom file", this};
+
+  // FFTW planning rigor if no wisdom is found ('patient', 'measure' or 'estimate')
+  oops::Parameter<std::string> fftwRigorWithoutWisdom{"fftw planning rigor without wisdom",
+    "measure", this};
+
   // Skip tests
   oops::Parameter<bool> skipTests{"skip tests", false, this};
 
@@ -98,6 +108,16 @@ class FastLAMParametersBase : public oops::Parameters {
   // Normalization accuracy stride (to reduce cost)
   oops::Parameter<size_t> normAccStride{"normalization accuracy stride", 10, this};
 
+  // Normalization accuracy method ('brute force', 'batched' or 'randomized')
+  oops::Parameter<std::string> normAccMethod{"normalization accuracy method", "brute force",
+    this};
+
+  // Number of samples for the randomized normalization accuracy method
+  oops::Parameter<size_t> normAccSamples{"normalization accuracy samples", 100, this};
+
+  // Validate normalization accuracy method against brute force
+  oops::Parameter<bool> normAccValidation{"normalization accuracy validation", false, this};
+
   // Multivariate strategy ('univariate', 'duplicated' or 'crossed')
   oops::RequiredParameter<std::string> strategy{"multivariate strategy", this};
 
@@ -106,6 +126,12 @@ class FastLAMParametersBase : public oops::Parameters {
 
   // Level for 2D variables ('first' or 'last')
   oops::Parameter<std::string> lev2d{"level for 2d variables", "first", this};
+
+  // Random number generator for randomization ('counter-based' or 'global')
+  oops::Parameter<std::string> randomGenerator{"random number generator", "counter-based", this};
+
+  // Randomization reproducibility test
+  oops::Parameter<bool> randomizationTest{"randomization reproducibility test", false, this};
 };
 
 // -----------------------------------------------------------------------------
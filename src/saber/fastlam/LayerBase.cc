@@ -22,6 +22,8 @@
 #include "oops/util/missingValues.h"
 #include "oops/util/Random.h"
 
+#include "saber/util/CounterBasedRandom.h"
+
 #define ERR(e) {throw eckit::Exception(nc_strerror(e), Here());}
 
 namespace saber {
@@ -228,34 +230,17 @@ void LayerBase::setupInterpolation() {
   if (noInterp_) {
     if (params_.parallelization.value() == "halo") {
       // Define reduced grid horizontal distribution
-      mpiTask_.resize(nx_*ny_, 0);
-      std::vector<int> mpiMask(nx_*ny_, 0);
+      std::vector<int> ownedPoints;
       for (size_t jnode0 = 0; jnode0 < mSize_; ++jnode0) {
         if (ghostView(jnode0) == 0) {
           int srcI = indexIView0(jnode0)-1;
           int srcJ = indexJView0(jnode0)-1;
-          mpiTask_[srcI*ny_+srcJ] = myrank_;
-          mpiMask[srcI*ny_+srcJ] = 1;
+          ownedPoints.push_back(srcI*ny_+srcJ);
         }
       }
 
-      // Check that every point is assigned to a task
-      comm_.allReduceInPlace(mpiTask_.begin(), mpiTask_.end(), eckit::mpi::sum());
-      comm_.allReduceInPlace(mpiMask.begin(), mpiMask.end(), eckit::mpi::sum());
-      for (size_t j = 0; j < ny_; ++j) {
-        for (size_t i = 0; i < nx_; ++i) {
-          if (mpiMask[i*ny_+j] == 0) {
-            oops::Log::info() << "Info     :     Point (i,j) = (" << i << "," << j << ")"
-              << std::endl;
-            throw eckit::Exception("task not define for this point", Here());
-          }
-          if (mpiMask[i*ny_+j] > 1) {
-            oops::Log::info() << "Info     :     Point (i,j) = (" << i << "," << j << ")"
-              << std::endl;
-            throw eckit::Exception("task defined more than once for this point", Here());
-          }
-        }
-      }
+      // Register and check ownership
+      setupOwnership(ownedPoints);
     }
 
     // Create reduced grid FunctionSpace on each task
@@ -287,61 +272,55 @@ void LayerBase::setupInterpolation() {
     fset_.add(fieldIndexI);
     fset_.add(fieldIndexJ);
   } else {
-    // Define reduced grid horizontal distribution
-    mpiTask_.resize(nx_*ny_, 0);
-    std::vector<int> mpiMask(nx_*ny_, 0);
+    // Define reduced grid horizontal distribution (only local model grid points are visited)
+    std::vector<int> ownedPoints;
+    std::vector<std::array<size_t, 2>> ownedIJ;
     for (size_t jnode0 = 0; jnode0 < mSize_; ++jnode0) {
       if (ghostView(jnode0) == 0) {
+        // Reduced grid coordinates are increasing with a step larger than one, so the colocated
+        // point (if any) is in the neighborhood of the ratio between indices
+        const int i0 = indexIView0(jnode0)-1;
+        const int j0 = indexJView0(jnode0)-1;
+        const int iGuess = static_cast<int>(std::round(static_cast<double>(i0)/dxCoord));
+        const int jGuess = static_cast<int>(std::round(static_cast<double>(j0)/dyCoord));
         int srcI = -1;
-        for (size_t i = 0; i < nx_; ++i) {
-          if (indexIView0(jnode0)-1 == std::round(xCoord[i])) {
+        for (int i = std::max(iGuess-1, 0); i <= std::min(iGuess+1, static_cast<int>(nx_)-1);
+          ++i) {
+          if (i0 == std::round(xCoord[i])) {
             srcI = i;
             break;
           }
         }
         int srcJ = -1;
-        for (size_t j = 0; j < ny_; ++j) {
-          if (indexJView0(jnode0)-1 == std::round(yCoord[j])) {
+        for (int j = std::max(jGuess-1, 0); j <= std::min(jGuess+1, static_cast<int>(ny_)-1);
+          ++j) {
+          if (j0 == std::round(yCoord[j])) {
             srcJ = j;
             break;
           }
         }
         if ((srcI > -1) && (srcJ > -1)) {
-          mpiTask_[srcI*ny_+srcJ] = myrank_;
-          mpiMask[srcI*ny_+srcJ] = 1;
+          ownedPoints.push_back(srcI*ny_+srcJ);
+          ownedIJ.push_back({static_cast<size_t>(srcI), static_cast<size_t>(srcJ)});
         }
       }
     }
 
-    // Check that every point is assigned to a task
-    comm_.allReduceInPlace(mpiTask_.begin(), mpiTask_.end(), eckit::mpi::sum());
-    comm_.allReduceInPlace(mpiMask.begin(), mpiMask.end(), eckit::mpi::sum());
-    for (size_t j = 0; j < ny_; ++j) {
-      for (size_t i = 0; i < nx_; ++i) {
-        if (mpiMask[i*ny_+j] == 0) {
-          oops::Log::info() << "Info     :     Point (i,j) = (" << i << "," << j << ")"
-            << std::endl;
-          throw eckit::Exception("task not define for this point", Here());
-        }
-        if (mpiMask[i*ny_+j] > 1) {
-          oops::Log::info() << "Info     :     Point (i,j) = (" << i << "," << j << ")"
-            << std::endl;
-          throw eckit::Exception("task defined more than once for this point", Here());
-        }
-      }
-    }
+    // Register and check ownership
+    setupOwnership(ownedPoints);
+
+    // Sort owned points with i varying fastest
+    std::stable_sort(ownedIJ.begin(), ownedIJ.end(),
+      [this](const std::array<size_t, 2> & p1, const std::array<size_t, 2> & p2)
+      {return p1[1]*nx_+p1[0] < p2[1]*nx_+p2[0];});
 
     // Create reduced grid FunctionSpace on each task
     std::vector<atlas::PointXY> v;
-    for (size_t j = 0; j < ny_; ++j) {
-      for (size_t i = 0; i < nx_; ++i) {
-        if (static_cast<size_t>(mpiTask_[i*ny_+j]) == myrank_) {
-          // Fake coordinate in [0,1]
-          atlas::PointXY p({xCoord[i]/static_cast<double>(nx0_-1),
-            yCoord[j]/static_cast<double>(ny0_-1)});
-          v.push_back(p);
-        }
-      }
+    for (const auto & ij : ownedIJ) {
+      // Fake coordinate in [0,1]
+      atlas::PointXY p({xCoord[ij[0]]/static_cast<double>(nx0_-1),
+        yCoord[ij[1]]/static_cast<double>(ny0_-1)});
+      v.push_back(p);
     }
     rSize_ = v.size();
     fspace_ = atlas::functionspace::PointCloud(v);
@@ -352,14 +331,10 @@ void LayerBase::setupInterpolation() {
     auto indexIView = atlas::array::make_view<int, 1>(fieldIndexI);
     auto indexJView = atlas::array::make_view<int, 1>(fieldIndexJ);
     size_t jnode = 0;
-    for (size_t j = 0; j < ny_; ++j) {
-      for (size_t i = 0; i < nx_; ++i) {
-        if (static_cast<size_t>(mpiTask_[i*ny_+j]) == myrank_) {
-          indexIView(jnode) = i+1;
-          indexJView(jnode) = j+1;
-          ++jnode;
-        }
-      }
+    for (const auto & ij : ownedIJ) {
+      indexIView(jnode) = ij[0]+1;
+      indexJView(jnode) = ij[1]+1;
+      ++jnode;
     }
     fset_.add(fieldIndexI);
     fset_.add(fieldIndexJ);
@@ -377,14 +352,40 @@ void LayerBase::setupInterpolation() {
     mTree.build(points0, indices0);
     const double radius = std::sqrt(dxCoord*dxCoord+dyCoord*dyCoord);
 
+    // Bounding box of local model grid points
+    int i0Min = nx0_;
+    int i0Max = -1;
+    int j0Min = ny0_;
+    int j0Max = -1;
+    for (size_t jnode0 = 0; jnode0 < mSize_; ++jnode0) {
+      if (ghostView(jnode0) == 0) {
+        i0Min = std::min(i0Min, indexIView0(jnode0)-1);
+        i0Max = std::max(i0Max, indexIView0(jnode0)-1);
+        j0Min = std::min(j0Min, indexJView0(jnode0)-1);
+        j0Max = std::max(j0Max, indexJView0(jnode0)-1);
+      }
+    }
+
+    // Reduced grid points that can contribute to the bounding box
+    size_t iStart = 0;
+    size_t iEnd = 0;
+    size_t jStart = 0;
+    size_t jEnd = 0;
+    if (i0Max > -1) {
+      iStart = std::max(static_cast<int>(static_cast<double>(i0Min)/dxCoord)-1, 0);
+      iEnd = std::min(static_cast<size_t>(static_cast<double>(i0Max)/dxCoord)+2, nx_);
+      jStart = std::max(static_cast<int>(static_cast<double>(j0Min)/dyCoord)-1, 0);
+      jEnd = std::min(static_cast<size_t>(static_cast<double>(j0Max)/dyCoord)+2, ny_);
+    }
+
     // RecvCounts and received points list
     mRecvCounts_.resize(comm_.size());
     std::fill(mRecvCounts_.begin(), mRecvCounts_.end(), 0);
     std::vector<int> mRecvPointsList;
-    for (size_t j = 0; j < ny_; ++j) {
+    for (size_t j = jStart; j < jEnd; ++j) {
       const double jMin = j > 0 ? yCoord[j-1] : yCoord[0];
       const double jMax = yCoord[std::min(j+1, ny_-1)];
-      for (size_t i = 0; i < nx_; ++i) {
+      for (size_t i = iStart; i < iEnd; ++i) {
         const double iMin = i > 0 ? xCoord[i-1] : xCoord[0];
         const double iMax = xCoord[std::min(i+1, nx_-1)];
         const atlas::Point3 p(xCoord[i], yCoord[j], 0.0);
@@ -403,12 +404,18 @@ void LayerBase::setupInterpolation() {
           }
         }
         if (pointsNeeded) {
-          ++mRecvCounts_[mpiTask_[i*ny_+j]];
           mRecvPointsList.push_back(i*ny_+j);
         }
       }
     }
 
+    // Get tasks owning the received points
+    std::vector<int> mRecvTasks;
+    getOwners(mRecvPointsList, mRecvTasks);
+    for (const auto & jt : mRecvTasks) {
+      ++mRecvCounts_[jt];
+    }
+
     // Buffer size
     mRecvSize_ = mRecvPointsList.size();
 
@@ -442,7 +449,7 @@ void LayerBase::setupInterpolation() {
     std::vector<size_t> mRecvOffset(comm_.size(), 0);
     std::vector<int> mRecvPointsListOrdered(mRecvSize_);
     for (size_t jr = 0; jr < mRecvSize_; ++jr) {
-      size_t jt = mpiTask_[mRecvPointsList[jr]];
+      size_t jt = mRecvTasks[jr];
       size_t jro = mRecvDispls_[jt]+mRecvOffset[jt];
       mRecvPointsListOrdered[jro] = mRecvPointsList[jr];
       ++mRecvOffset[jt];
@@ -638,6 +645,158 @@ void LayerBase::setupInterpolation() {
 
 // -----------------------------------------------------------------------------
 
+void LayerBase::setupOwnership(const std::vector<int> & ownedPoints) {
+  oops::Log::trace() << classname() << "::setupOwnership starting" << std::endl;
+
+  // The ownership of reduced grid point g = i*ny_+j is stored on the directory task g/dirSize_,
+  // so that no task has to hold the full reduced grid distribution.
+  const size_t nTasks = comm_.size();
+  dirSize_ = (nx_*ny_+nTasks-1)/nTasks;
+  const size_t dirStart = std::min(myrank_*dirSize_, nx_*ny_);
+  const size_t dirEnd = std::min(dirStart+dirSize_, nx_*ny_);
+  dirTask_.resize(dirEnd-dirStart);
+  std::fill(dirTask_.begin(), dirTask_.end(), -1);
+
+  // SendCounts
+  std::vector<int> sendCounts(nTasks, 0);
+  for (const auto & g : ownedPoints) {
+    ++sendCounts[g/dirSize_];
+  }
+
+  // SendDispls
+  std::vector<int> sendDispls(nTasks, 0);
+  for (size_t jt = 0; jt < nTasks-1; ++jt) {
+    sendDispls[jt+1] = sendDispls[jt]+sendCounts[jt];
+  }
+
+  // Ordered sent points list
+  std::vector<int> sendOffset(nTasks, 0);
+  std::vector<int> sendPointsList(ownedPoints.size());
+  for (const auto & g : ownedPoints) {
+    const size_t jt = g/dirSize_;
+    sendPointsList[sendDispls[jt]+sendOffset[jt]] = g;
+    ++sendOffset[jt];
+  }
+
+  // RecvCounts and RecvDispls
+  std::vector<int> recvCounts(nTasks);
+  comm_.allToAll(sendCounts, recvCounts);
+  std::vector<int> recvDispls(nTasks, 0);
+  for (size_t jt = 0; jt < nTasks-1; ++jt) {
+    recvDispls[jt+1] = recvDispls[jt]+recvCounts[jt];
+  }
+  const size_t recvSize = recvDispls[nTasks-1]+recvCounts[nTasks-1];
+
+  // Communication
+  std::vector<int> recvPointsList(recvSize);
+  comm_.allToAllv(sendPointsList.data(), sendCounts.data(), sendDispls.data(),
+    recvPointsList.data(), recvCounts.data(), recvDispls.data());
+
+  // Fill directory
+  int nDefinedTwice = 0;
+  for (size_t jt = 0; jt < nTasks; ++jt) {
+    for (int jr = recvDispls[jt]; jr < recvDispls[jt]+recvCounts[jt]; ++jr) {
+      const size_t g = recvPointsList[jr];
+      if (dirTask_[g-dirStart] > -1) {
+        oops::Log::info() << "Info     :     Point (i,j) = (" << g/ny_ << "," << g%ny_ << ")"
+          << std::endl;
+        ++nDefinedTwice;
+      }
+      dirTask_[g-dirStart] = jt;
+    }
+  }
+
+  // Check that every point is assigned to a task
+  int nUndefined = 0;
+  for (size_t jd = 0; jd < dirTask_.size(); ++jd) {
+    if (dirTask_[jd] == -1) {
+      const size_t g = dirStart+jd;
+      oops::Log::info() << "Info     :     Point (i,j) = (" << g/ny_ << "," << g%ny_ << ")"
+        << std::endl;
+      ++nUndefined;
+    }
+  }
+  comm_.allReduceInPlace(nUndefined, eckit::mpi::sum());
+  comm_.allReduceInPlace(nDefinedTwice, eckit::mpi::sum());
+  if (nUndefined > 0) {
+    throw eckit::Exception("task not define for this point", Here());
+  }
+  if (nDefinedTwice > 0) {
+    throw eckit::Exception("task defined more than once for this point", Here());
+  }
+
+  oops::Log::trace() << classname() << "::setupOwnership done" << std::endl;
+}
+
+// -----------------------------------------------------------------------------
+
+void LayerBase::getOwners(const std::vector<int> & pointsList,
+                          std::vector<int> & tasksList) const {
+  oops::Log::trace() << classname() << "::getOwners starting" << std::endl;
+
+  // Directory start index
+  const size_t nTasks = comm_.size();
+  const size_t dirStart = std::min(myrank_*dirSize_, nx_*ny_);
+
+  // SendCounts
+  std::vector<int> sendCounts(nTasks, 0);
+  for (const auto & g : pointsList) {
+    ++sendCounts[g/dirSize_];
+  }
+
+  // SendDispls
+  std::vector<int> sendDispls(nTasks, 0);
+  for (size_t jt = 0; jt < nTasks-1; ++jt) {
+    sendDispls[jt+1] = sendDispls[jt]+sendCounts[jt];
+  }
+
+  // Ordered requested points list
+  std::vector<int> sendOffset(nTasks, 0);
+  std::vector<int> sendPointsList(pointsList.size());
+  std::vector<size_t> sendMapping(pointsList.size());
+  for (size_t jp = 0; jp < pointsList.size(); ++jp) {
+    const size_t jt = pointsList[jp]/dirSize_;
+    sendMapping[jp] = sendDispls[jt]+sendOffset[jt];
+    sendPointsList[sendMapping[jp]] = pointsList[jp];
+    ++sendOffset[jt];
+  }
+
+  // RecvCounts and RecvDispls
+  std::vector<int> recvCounts(nTasks);
+  comm_.allToAll(sendCounts, recvCounts);
+  std::vector<int> recvDispls(nTasks, 0);
+  for (size_t jt = 0; jt < nTasks-1; ++jt) {
+    recvDispls[jt+1] = recvDispls[jt]+recvCounts[jt];
+  }
+  const size_t recvSize = recvDispls[nTasks-1]+recvCounts[nTasks-1];
+
+  // Send requests to directory tasks
+  std::vector<int> recvPointsList(recvSize);
+  comm_.allToAllv(sendPointsList.data(), sendCounts.data(), sendDispls.data(),
+    recvPointsList.data(), recvCounts.data(), recvDispls.data());
+
+  // Look up owners
+  std::vector<int> recvTasksList(recvSize);
+  for (size_t jr = 0; jr < recvSize; ++jr) {
+    recvTasksList[jr] = dirTask_[recvPointsList[jr]-dirStart];
+  }
+
+  // Send answers back
+  std::vector<int> sendTasksList(pointsList.size());
+  comm_.allToAllv(recvTasksList.data(), recvCounts.data(), recvDispls.data(),
+    sendTasksList.data(), sendCounts.data(), sendDispls.data());
+
+  // Reorder owners
+  tasksList.resize(pointsList.size());
+  for (size_t jp = 0; jp < pointsList.size(); ++jp) {
+    tasksList[jp] = sendTasksList[sendMapping[jp]];
+  }
+
+  oops::Log::trace() << classname() << "::getOwners done" << std::endl;
+}
+
+// -----------------------------------------------------------------------------
+
 void LayerBase::testInterpolation(const std::vector<double> & zCoord) const {
   oops::Log::trace() << classname() << "::testInterpolation starting" << std::endl;
 
@@ -1018,7 +1177,7 @@ void LayerBase::setupNormalization() {
   }
 
   // Check whether normalization accuracy should be computed
-  bool computeNormAcc = false;
+  bool computeNormAcc = params_.normAccValidation.value();
   std::vector<eckit::LocalConfiguration> outputModelFilesConf
     = params_.outputModelFilesConf.value().get_value_or({});
   for (const auto & conf : outputModelFilesConf) {
@@ -1029,85 +1188,442 @@ void LayerBase::setupNormalization() {
   }
 
   if (computeNormAcc) {
-    // Brute-force normalization to assess cost-effective normalization accuracy
-
-    // Create fields
-    atlas::Field modelField = gdata_.functionSpace().createField<double>(
-      atlas::option::name("dummy") | atlas::option::levels(nz0_));
-    atlas::Field cv("genericCtlVec", atlas::array::make_datatype<double>(),
-      atlas::array::make_shape(ctlVecSize()));
-    auto modelView = atlas::array::make_view<double, 2>(modelField);
-
-    // Model grid indices
-    const atlas::functionspace::StructuredColumns fs(gdata_.functionSpace());
-    atlas::Field fieldIndexI0 = fs.index_i();
-    atlas::Field fieldIndexJ0 = fs.index_j();
-    auto indexIView0 = atlas::array::make_view<int, 1>(fieldIndexI0);
-    auto indexJView0 = atlas::array::make_view<int, 1>(fieldIndexJ0);
-
-    // Compute normalization accuracy
-    oops::Log::info() << "Info     :     Compute exact normalization" << std::endl;
+    // Exact normalization to assess cost-effective normalization accuracy
+    const std::string method = params_.normAccMethod.value();
+    oops::Log::info() << "Info     :     Compute exact normalization (" << method << ")"
+      << std::endl;
+    atlas::Field exactNormField = gdata_.functionSpace().createField<double>(
+      atlas::option::name(myGroup_) | atlas::option::levels(nz0_));
+    double errorBound = 0.0;
+    if (method == "brute force") {
+      exactNormalizationBruteForce(exactNormField);
+    } else if (method == "batched") {
+      exactNormalizationBatched(exactNormField);
+    } else if (method == "randomized") {
+      exactNormalizationRandomized(exactNormField, errorBound);
+    } else {
+      throw eckit::UserError("wrong normalization accuracy method: " + method, Here());
+    }
+
+    // Assess cost-efficient normalization quality
     atlas::Field normAccField = gdata_.functionSpace().createField<double>(
       atlas::option::name(myGroup_) | atlas::option::levels(nz0_));
     auto normAccView = atlas::array::make_view<double, 2>(normAccField);
+    const auto exactNormView = atlas::array::make_view<double, 2>(exactNormField);
     normAccView.assign(util::missingValue<double>());
-    double normAccMax = 0.0;;
-
-    // Sort indices
-    std::vector<int> gij0(mSize_);
+    double normAccMax = 0.0;
     for (size_t jnode0 = 0; jnode0 < mSize_; ++jnode0) {
-      gij0[jnode0] = (indexIView0(jnode0)-1)*ny0_+indexJView0(jnode0)-1;
+      if (ghostView(jnode0) == 0) {
+        for (size_t k0 = 0; k0 < nz0_; ++k0) {
+          if (exactNormView(jnode0, k0) != util::missingValue<double>()) {
+            normAccView(jnode0, k0) = (normView(jnode0, k0)-exactNormView(jnode0, k0))
+              /exactNormView(jnode0, k0);
+            normAccMax = std::max(normAccMax, std::abs(normAccView(jnode0, k0)));
+          }
+        }
+      }
     }
-    std::vector<size_t> gidx(mSize_);
-    std::iota(gidx.begin(), gidx.end(), 0);
-    std::stable_sort(gidx.begin(), gidx.end(),
-      [&gij0](size_t i1, size_t i2) {return gij0[i1] < gij0[i2];});
-
-    for (size_t i0 = 0; i0 < nx0_; i0 += params_.normAccStride.value()) {
-      for (size_t j0 = 0; j0 < ny0_; j0 += params_.normAccStride.value()) {
-        // Binary search
-        size_t valueToFind = i0*ny0_+j0;
-        int myJnode0;
-        binarySearch(gij0, gidx, valueToFind, myJnode0);
-
-        for (size_t k0 = 0; k0 < nz0_; k0 += params_.normAccStride.value()) {
-          // Set Dirac point
-          modelView.assign(0.0);
-          if (myJnode0 > -1) {
-            modelView(myJnode0, k0) = 1.0;
+    normAcc_.add(normAccField);
+    comm_.allReduceInPlace(normAccMax, eckit::mpi::max());
+    oops::Log::info() << "Info     :     Cost-effective normalization maximum error: "
+      << normAccMax << std::endl;
+
+    if (params_.normAccValidation.value()) {
+      // Compare with brute-force exact normalization
+      atlas::Field refNormField = gdata_.functionSpace().createField<double>(
+        atlas::option::name(myGroup_) | atlas::option::levels(nz0_));
+      exactNormalizationBruteForce(refNormField);
+      const auto refNormView = atlas::array::make_view<double, 2>(refNormField);
+      double diffMax = 0.0;
+      for (size_t jnode0 = 0; jnode0 < mSize_; ++jnode0) {
+        if (ghostView(jnode0) == 0) {
+          for (size_t k0 = 0; k0 < nz0_; ++k0) {
+            if ((refNormView(jnode0, k0) != util::missingValue<double>())
+              && (exactNormView(jnode0, k0) != util::missingValue<double>())) {
+              diffMax = std::max(diffMax, std::abs(exactNormView(jnode0, k0)
+                -refNormView(jnode0, k0))/refNormView(jnode0, k0));
+            }
           }
+        }
+      }
+      comm_.allReduceInPlace(diffMax, eckit::mpi::max());
+
+      // Exact methods should match to rounding errors, randomized method within five standard
+      // errors
+      const double tolerance = (method == "randomized") ? 5.0*errorBound : 1.0e-10;
+      oops::Log::info() << std::setprecision(16) << "Info     :     Normalization accuracy "
+        << "validation: maximum relative difference with brute force = " << diffMax
+        << " (tolerance = " << tolerance << ")" << std::endl;
+      oops::Log::test() << "    FastLAM normalization accuracy validation";
+      if (diffMax < tolerance) {
+        oops::Log::test() << " passed" << std::endl;
+      } else {
+        oops::Log::test() << " failed" << std::endl;
+        throw eckit::Exception("normalization accuracy validation failed for block FastLAM",
+          Here());
+      }
+    }
+  }
+
+  oops::Log::trace() << classname() << "::setupNormalization done" << std::endl;
+}
+
+// -----------------------------------------------------------------------------
+
+void LayerBase::exactNormalizationBruteForce(atlas::Field & exactNormField) {
+  oops::Log::trace() << classname() << "::exactNormalizationBruteForce starting" << std::endl;
+
+  // Create fields
+  atlas::Field modelField = gdata_.functionSpace().createField<double>(
+    atlas::option::name("dummy") | atlas::option::levels(nz0_));
+  atlas::Field cv("genericCtlVec", atlas::array::make_datatype<double>(),
+    atlas::array::make_shape(ctlVecSize()));
+  auto modelView = atlas::array::make_view<double, 2>(modelField);
+  auto exactNormView = atlas::array::make_view<double, 2>(exactNormField);
+  exactNormView.assign(util::missingValue<double>());
+
+  // Sort indices
+  std::vector<int> gij0;
+  std::vector<size_t> gidx;
+  sortModelIndices(gij0, gidx);
+
+  for (size_t i0 = 0; i0 < nx0_; i0 += params_.normAccStride.value()) {
+    for (size_t j0 = 0; j0 < ny0_; j0 += params_.normAccStride.value()) {
+      // Binary search
+      size_t valueToFind = i0*ny0_+j0;
+      int myJnode0;
+      binarySearch(gij0, gidx, valueToFind, myJnode0);
+
+      for (size_t k0 = 0; k0 < nz0_; k0 += params_.normAccStride.value()) {
+        // Set Dirac point
+        modelView.assign(0.0);
+        if (myJnode0 > -1) {
+          modelView(myJnode0, k0) = 1.0;
+        }
+
+        // Adjoint square-root multiplication
+        const size_t offset = 0;
+        multiplySqrtTrans(modelField, cv, offset);
+
+        // Compute exact normalization
+        double exactNorm = 0.0;
+        const auto cvView = atlas::array::make_view<double, 1>(cv);
+        for (size_t jj = 0; jj < ctlVecSize(); ++jj) {
+          exactNorm += cvView(jj)*cvView(jj);
+        }
+        comm_.allReduceInPlace(exactNorm, eckit::mpi::sum());
+
+        // Get exact normalization factor
+        ASSERT(exactNorm > 0.0);
+        if (myJnode0 > -1) {
+          exactNormView(myJnode0, k0) = 1.0/std::sqrt(exactNorm);
+        }
+      }
+    }
+  }
+
+  oops::Log::trace() << classname() << "::exactNormalizationBruteForce done" << std::endl;
+}
+
+// -----------------------------------------------------------------------------
+
+void LayerBase::exactNormalizationBatched(atlas::Field & exactNormField) {
+  oops::Log::trace() << classname() << "::exactNormalizationBatched starting" << std::endl;
+
+  // The covariance S.S^T couples two model grid points only if their reduced grid
+  // interpolation stencils are closer than the kernel size. Dirac points that are further
+  // apart in every direction can be propagated together, each diagonal value being read at its
+  // own Dirac point. Points sampled with the normalization accuracy stride are split into such
+  // colors, direction by direction.
+  const size_t stride = params_.normAccStride.value();
+  auto color = [](const std::vector<size_t> & index, const size_t & minDist) {
+    std::vector<std::vector<size_t>> colors;
+    for (size_t jj = 0; jj < index.size(); ++jj) {
+      bool found = false;
+      for (auto & col : colors) {
+        if (index[jj]-index[col.back()] >= minDist) {
+          col.push_back(jj);
+          found = true;
+          break;
+        }
+      }
+      if (!found) {
+        colors.push_back({jj});
+      }
+    }
+    return colors;
+  };
+
+  // Sampled points and their lower reduced grid index
+  std::vector<size_t> iSample;
+  std::vector<size_t> iRed;
+  for (size_t i0 = 0; i0 < nx0_; i0 += stride) {
+    iSample.push_back(i0);
+    iRed.push_back(static_cast<size_t>(static_cast<double>(i0)/xRedFac_));
+  }
+  std::vector<size_t> jSample;
+  std::vector<size_t> jRed;
+  for (size_t j0 = 0; j0 < ny0_; j0 += stride) {
+    jSample.push_back(j0);
+    jRed.push_back(static_cast<size_t>(static_cast<double>(j0)/yRedFac_));
+  }
+  std::vector<size_t> kSample;
+  std::vector<size_t> kRed;
+  for (size_t k0 = 0; k0 < nz0_; k0 += stride) {
+    kSample.push_back(k0);
+    kRed.push_back(verIndex_[k0]);
+  }
+
+  // Colors (stencils are two points wide)
+  const std::vector<std::vector<size_t>> iColors = color(iRed, xKernelSize_+1);
+  const std::vector<std::vector<size_t>> jColors = color(jRed, yKernelSize_+1);
+  const std::vector<std::vector<size_t>> kColors = color(kRed, zKernelSize_+1);
+  oops::Log::info() << "Info     :     Batched normalization: "
+    << iColors.size()*jColors.size()*kColors.size() << " operator applications instead of "
+    << iSample.size()*jSample.size()*kSample.size() << std::endl;
 
-          // Adjoint square-root multiplication
-          const size_t offset = 0;
-          multiplySqrtTrans(modelField, cv, offset);
+  // Create fields
+  atlas::Field modelField = gdata_.functionSpace().createField<double>(
+    atlas::option::name("dummy") | atlas::option::levels(nz0_));
+  atlas::Field cv("genericCtlVec", atlas::array::make_datatype<double>(),
+    atlas::array::make_shape(ctlVecSize()));
+  auto modelView = atlas::array::make_view<double, 2>(modelField);
+  auto exactNormView = atlas::array::make_view<double, 2>(exactNormField);
+  exactNormView.assign(util::missingValue<double>());
 
-          // Compute exact normalization
-          double exactNorm = 0.0;
-          const auto cvView = atlas::array::make_view<double, 1>(cv);
-          for (size_t jj = 0; jj < ctlVecSize(); ++jj) {
-            exactNorm += cvView(jj)*cvView(jj);
+  // Ghost points
+  const auto ghostView = atlas::array::make_view<int, 1>(gdata_.functionSpace().ghost());
+
+  // Sort indices
+  std::vector<int> gij0;
+  std::vector<size_t> gidx;
+  sortModelIndices(gij0, gidx);
+
+  for (const auto & iCol : iColors) {
+    for (const auto & jCol : jColors) {
+      // Local Dirac points of this horizontal color (owned points only, a Dirac point on a
+      // halo copy would not survive the square-root multiplications)
+      std::vector<int> jnode0List;
+      for (const auto & ii : iCol) {
+        for (const auto & jj : jCol) {
+          size_t valueToFind = iSample[ii]*ny0_+jSample[jj];
+          int myJnode0;
+          binarySearch(gij0, gidx, valueToFind, myJnode0);
+          if ((myJnode0 > -1) && (ghostView(myJnode0) == 0)) {
+            jnode0List.push_back(myJnode0);
+          }
+        }
+      }
+
+      for (const auto & kCol : kColors) {
+        // Set Dirac points
+        modelView.assign(0.0);
+        for (const auto & jnode0 : jnode0List) {
+          for (const auto & kk : kCol) {
+            modelView(jnode0, kSample[kk]) = 1.0;
           }
-          comm_.allReduceInPlace(exactNorm, eckit::mpi::sum());
+        }
 
-          // Get exact normalization factor
-          ASSERT(exactNorm > 0.0);
-          exactNorm = 1.0/std::sqrt(exactNorm);
+        // Covariance multiplication
+        const size_t offset = 0;
+        multiplySqrtTrans(modelField, cv, offset);
+        multiplySqrt(cv, modelField, offset);
 
-          // Assess cost-efficient normalization quality
-          if (myJnode0 > -1) {
-            normAccView(myJnode0, k0) = (normView(myJnode0, k0)-exactNorm)/exactNorm;
-            normAccMax = std::max(normAccMax, std::abs(normAccView(myJnode0, k0)));
+        // Get exact normalization factor at Dirac points
+        for (const auto & jnode0 : jnode0List) {
+          for (const auto & kk : kCol) {
+            ASSERT(modelView(jnode0, kSample[kk]) > 0.0);
+            exactNormView(jnode0, kSample[kk]) = 1.0/std::sqrt(modelView(jnode0, kSample[kk]));
           }
         }
       }
     }
-    normAcc_.add(normAccField);
-    comm_.allReduceInPlace(normAccMax, eckit::mpi::max());
-    oops::Log::info() << "Info     :     Cost-effective normalization maximum error: "
-      << normAccMax << std::endl;
   }
 
-  oops::Log::trace() << classname() << "::setupNormalization done" << std::endl;
+  oops::Log::trace() << classname() << "::exactNormalizationBatched done" << std::endl;
+}
+
+// -----------------------------------------------------------------------------
+
+void LayerBase::exactNormalizationRandomized(atlas::Field & exactNormField,
+                                             double & errorBound) {
+  oops::Log::trace() << classname() << "::exactNormalizationRandomized starting" << std::endl;
+
+  // Ghost points
+  const auto ghostView = atlas::array::make_view<int, 1>(gdata_.functionSpace().ghost());
+
+  // Create fields
+  atlas::Field modelField = gdata_.functionSpace().createField<double>(
+    atlas::option::name("dummy") | atlas::option::levels(nz0_));
+  atlas::Field cv("genericCtlVec", atlas::array::make_datatype<double>(),
+    atlas::array::make_shape(ctlVecSize()));
+  const auto modelView = atlas::array::make_view<double, 2>(modelField);
+  auto cvView = atlas::array::make_view<double, 1>(cv);
+  auto exactNormView = atlas::array::make_view<double, 2>(exactNormField);
+  exactNormView.assign(0.0);
+
+  // Global indices of the control vector elements
+  std::vector<size_t> indices;
+  ctlVecIndices(indices);
+  ASSERT(indices.size() == ctlVecSize());
+
+  // The diagonal of S.S^T is the variance of S.w for w ~ N(0,I), estimated from samples
+  const size_t nSamples = params_.normAccSamples.value();
+  ASSERT(nSamples > 0);
+  const std::uint64_t seed = 7;  // For reproducibility
+  for (size_t js = 0; js < nSamples; ++js) {
+    // Random control vector, one stream per sample indexed by the global index on the control
+    // grid, so that the samples do not depend on the MPI decomposition
+    for (size_t jj = 0; jj < ctlVecSize(); ++jj) {
+      cvView(jj) = util::counterBasedNormal(seed, js, indices[jj]);
+    }
+
+    // Square-root multiplication
+    const size_t offset = 0;
+    multiplySqrt(cv, modelField, offset);
+
+    // Accumulate squares
+    for (size_t jnode0 = 0; jnode0 < mSize_; ++jnode0) {
+      if (ghostView(jnode0) == 0) {
+        for (size_t k0 = 0; k0 < nz0_; ++k0) {
+          exactNormView(jnode0, k0) += modelView(jnode0, k0)*modelView(jnode0, k0);
+        }
+      }
+    }
+  }
+
+  // Get normalization factor
+  for (size_t jnode0 = 0; jnode0 < mSize_; ++jnode0) {
+    for (size_t k0 = 0; k0 < nz0_; ++k0) {
+      if (ghostView(jnode0) == 0 && exactNormView(jnode0, k0) > 0.0) {
+        exactNormView(jnode0, k0) = 1.0/std::sqrt(exactNormView(jnode0, k0)
+          /static_cast<double>(nSamples));
+      } else {
+        exactNormView(jnode0, k0) = util::missingValue<double>();
+      }
+    }
+  }
+
+  // Relative standard error of the normalization factor (the variance estimate being
+  // chi-squared distributed with nSamples degrees of freedom)
+  errorBound = 1.0/std::sqrt(2.0*static_cast<double>(nSamples));
+  oops::Log::info() << "Info     :     Randomized normalization with " << nSamples
+    << " samples, relative standard error: " << errorBound << std::endl;
+
+  oops::Log::trace() << classname() << "::exactNormalizationRandomized done" << std::endl;
+}
+
+// -----------------------------------------------------------------------------
+
+void LayerBase::sortModelIndices(std::vector<int> & gij0,
+                                 std::vector<size_t> & gidx) const {
+  oops::Log::trace() << classname() << "::sortModelIndices starting" << std::endl;
+
+  // Model grid indices
+  const atlas::functionspace::StructuredColumns fs(gdata_.functionSpace());
+  atlas::Field fieldIndexI0 = fs.index_i();
+  atlas::Field fieldIndexJ0 = fs.index_j();
+  auto indexIView0 = atlas::array::make_view<int, 1>(fieldIndexI0);
+  auto indexJView0 = atlas::array::make_view<int, 1>(fieldIndexJ0);
+
+  // Sort indices
+  gij0.resize(mSize_);
+  for (size_t jnode0 = 0; jnode0 < mSize_; ++jnode0) {
+    gij0[jnode0] = (indexIView0(jnode0)-1)*ny0_+indexJView0(jnode0)-1;
+  }
+  gidx.resize(mSize_);
+  std::iota(gidx.begin(), gidx.end(), 0);
+  std::stable_sort(gidx.begin(), gidx.end(),
+    [&gij0](size_t i1, size_t i2) {return gij0[i1] < gij0[i2];});
+
+  oops::Log::trace() << classname() << "::sortModelIndices done" << std::endl;
+}
+
+// -----------------------------------------------------------------------------
+
+void LayerBase::multiplySqrt(const atlas::Field & cv,
+                             atlas::Field & modelField,
+                             const size_t & offset) const {
+  oops::Log::trace() << classname() << "::multiplySqrt starting" << std::endl;
+
+  // Create field on reduced grid
+  atlas::Field redField = fspace_.createField<double>(atlas::option::name("dummy") |
+    atlas::option::levels(nz_));
+
+  // Square-root multiplication, on reduced grid
+  multiplySqrtOnRed(cv, redField, offset);
+
+  // Interpolation TL
+  interpolationTL(redField, modelField);
+
+  oops::Log::trace() << classname() << "::multiplySqrt done" << std::endl;
+}
+
+// -----------------------------------------------------------------------------
+
+void LayerBase::multiplySqrtTrans(const atlas::Field & modelField,
+                                  atlas::Field & cv,
+                                  const size_t & offset) const {
+  oops::Log::trace() << classname() << "::multiplySqrtTrans starting" << std::endl;
+
+  // Create field on reduced grid
+  atlas::Field redField = fspace_.createField<double>(atlas::option::name("dummy") |
+    atlas::option::levels(nz_));
+
+  // Interpolation AD
+  interpolationAD(modelField, redField);
+
+  // Adjoint square-root multiplication, on reduced grid
+  multiplySqrtTransOnRed(redField, cv, offset);
+
+  oops::Log::trace() << classname() << "::multiplySqrtTrans done" << std::endl;
+}
+
+// -----------------------------------------------------------------------------
+
+void LayerBase::multiplySqrt(const atlas::Field & cv,
+                             std::vector<atlas::Field> & modelFields,
+                             const size_t & offset) const {
+  oops::Log::trace() << classname() << "::multiplySqrt starting" << std::endl;
+
+  // Square-root multiplication on reduced grid, one control vector chunk per field
+  std::vector<atlas::Field> redFields;
+  for (size_t jf = 0; jf < modelFields.size(); ++jf) {
+    atlas::Field redField = fspace_.createField<double>(atlas::option::name("dummy") |
+      atlas::option::levels(nz_));
+    multiplySqrtOnRed(cv, redField, offset+jf*ctlVecSize());
+    redFields.push_back(redField);
+  }
+
+  // Interpolation TL, all fields at once
+  interpolationTL(redFields, modelFields);
+
+  oops::Log::trace() << classname() << "::multiplySqrt done" << std::endl;
+}
+
+// -----------------------------------------------------------------------------
+
+void LayerBase::multiplySqrtTrans(const std::vector<atlas::Field> & modelFields,
+                                  atlas::Field & cv,
+                                  const size_t & offset) const {
+  oops::Log::trace() << classname() << "::multiplySqrtTrans starting" << std::endl;
+
+  // Create fields on reduced grid
+  std::vector<atlas::Field> redFields;
+  for (size_t jf = 0; jf < modelFields.size(); ++jf) {
+    redFields.push_back(fspace_.createField<double>(atlas::option::name("dummy") |
+      atlas::option::levels(nz_)));
+  }
+
+  // Interpolation AD, all fields at once
+  interpolationAD(modelFields, redFields);
+
+  // Adjoint square-root multiplication on reduced grid, one control vector chunk per field
+  for (size_t jf = 0; jf < modelFields.size(); ++jf) {
+    multiplySqrtTransOnRed(redFields[jf], cv, offset+jf*ctlVecSize());
+  }
+
+  oops::Log::trace() << classname() << "::multiplySqrtTrans done" << std::endl;
 }
 
 // -----------------------------------------------------------------------------
@@ -1284,59 +1800,112 @@ void LayerBase::interpolationTL(const atlas::Field & redField,
                                 atlas::Field & modelField) const {
   oops::Log::trace() << classname() << "::interpolationTL starting" << std::endl;
 
+  // Single field version
+  const std::vector<atlas::Field> redFields({redField});
+  std::vector<atlas::Field> modelFields({modelField});
+  interpolationTL(redFields, modelFields);
+
+  oops::Log::trace() << classname() << "::interpolationTL done" << std::endl;
+}
+
+// -----------------------------------------------------------------------------
+
+void LayerBase::interpolationAD(const atlas::Field & modelField,
+                                atlas::Field & redField) const {
+  oops::Log::trace() << classname() << "::interpolationAD starting" << std::endl;
+
+  // Single field version
+  const std::vector<atlas::Field> modelFields({modelField});
+  std::vector<atlas::Field> redFields({redField});
+  interpolationAD(modelFields, redFields);
+
+  oops::Log::trace() << classname() << "::interpolationAD done" << std::endl;
+}
+
+// -----------------------------------------------------------------------------
+
+void LayerBase::interpolationTL(const std::vector<atlas::Field> & redFields,
+                                std::vector<atlas::Field> & modelFields) const {
+  oops::Log::trace() << classname() << "::interpolationTL starting" << std::endl;
+
+  // Number of fields
+  const size_t nf = redFields.size();
+  ASSERT(modelFields.size() == nf);
+
   // Initialization
-  const auto redView = atlas::array::make_view<double, 2>(redField);
-  auto modelView = atlas::array::make_view<double, 2>(modelField);
-  modelView.assign(0.0);
+  std::vector<atlas::array::ArrayView<double, 2>> redViews;
+  std::vector<atlas::array::ArrayView<double, 2>> modelViews;
+  for (size_t jf = 0; jf < nf; ++jf) {
+    redViews.push_back(atlas::array::make_view<double, 2>(redFields[jf]));
+    modelViews.push_back(atlas::array::make_view<double, 2>(modelFields[jf]));
+    modelViews[jf].assign(0.0);
+  }
 
   // Ghost points
   const auto ghostView = atlas::array::make_view<int, 1>(gdata_.functionSpace().ghost());
 
   if (noInterp_) {
     // No horizontal interpolation
-    for (size_t jnode0 = 0; jnode0 < mSize_; ++jnode0) {
-      if (ghostView(jnode0) == 0) {
-        for (size_t k0 = 0; k0 < nz0_; ++k0) {
-          for (size_t jv = 0; jv < verStencilSize_[k0]; ++jv) {
-            modelView(jnode0, k0) += verWeights_[k0][jv]*redView(jnode0, verStencil_[k0][jv]);
+    for (size_t jf = 0; jf < nf; ++jf) {
+      for (size_t jnode0 = 0; jnode0 < mSize_; ++jnode0) {
+        if (ghostView(jnode0) == 0) {
+          for (size_t k0 = 0; k0 < nz0_; ++k0) {
+            for (size_t jv = 0; jv < verStencilSize_[k0]; ++jv) {
+              modelViews[jf](jnode0, k0) += verWeights_[k0][jv]
+                *redViews[jf](jnode0, verStencil_[k0][jv]);
+            }
           }
         }
       }
     }
   } else {
-    // Scale counts and displs for all levels
+    // Scale counts and displs for all levels and fields
+    const size_t nzf = nz_*nf;
     std::vector<int> rSendCounts3D(comm_.size());
     std::vector<int> rSendDispls3D(comm_.size());
     std::vector<int> mRecvCounts3D(comm_.size());
     std::vector<int> mRecvDispls3D(comm_.size());
     for (size_t jt = 0; jt < comm_.size(); ++jt) {
-      rSendCounts3D[jt] = rSendCounts_[jt]*nz_;
-      rSendDispls3D[jt] = rSendDispls_[jt]*nz_;
-      mRecvCounts3D[jt] = mRecvCounts_[jt]*nz_;
-      mRecvDispls3D[jt] = mRecvDispls_[jt]*nz_;
+      rSendCounts3D[jt] = rSendCounts_[jt]*nzf;
+      rSendDispls3D[jt] = rSendDispls_[jt]*nzf;
+      mRecvCounts3D[jt] = mRecvCounts_[jt]*nzf;
+      mRecvDispls3D[jt] = mRecvDispls_[jt]*nzf;
     }
 
-    // Serialize
-    std::vector<double> rSendVec(rSendSize_*nz_);
+    // Serialize, with fields as the innermost dimension
+    std::vector<double> rSendVec(rSendSize_*nzf);
     for (size_t js = 0; js < rSendSize_; ++js) {
       const size_t jnode = rSendMapping_[js];
       for (size_t k = 0; k < nz_; ++k) {
-        rSendVec[js*nz_+k] = redView(jnode, k);
+        for (size_t jf = 0; jf < nf; ++jf) {
+          rSendVec[(js*nz_+k)*nf+jf] = redViews[jf](jnode, k);
+        }
       }
     }
 
     // Communication
-    std::vector<double> mRecvVec(mRecvSize_*nz_);
+    std::vector<double> mRecvVec(mRecvSize_*nzf);
     comm_.allToAllv(rSendVec.data(), rSendCounts3D.data(), rSendDispls3D.data(),
       mRecvVec.data(), mRecvCounts3D.data(), mRecvDispls3D.data());
 
     // Interpolation
+    std::vector<double> modelVec(nf);
     for (size_t jnode0 = 0; jnode0 < mSize_; ++jnode0) {
-      for (size_t jh = 0; jh < horStencilSize_[jnode0]; ++jh) {
+      if (horStencilSize_[jnode0] > 0) {
         for (size_t k0 = 0; k0 < nz0_; ++k0) {
-          for (size_t jv = 0; jv < verStencilSize_[k0]; ++jv) {
-            const size_t mIndex = horStencil_[jnode0][jh]*nz_+verStencil_[k0][jv];
-            modelView(jnode0, k0) += horWeights_[jnode0][jh]*verWeights_[k0][jv]*mRecvVec[mIndex];
+          std::fill(modelVec.begin(), modelVec.end(), 0.0);
+          for (size_t jh = 0; jh < horStencilSize_[jnode0]; ++jh) {
+            for (size_t jv = 0; jv < verStencilSize_[k0]; ++jv) {
+              const double w = horWeights_[jnode0][jh]*verWeights_[k0][jv];
+              const double * mRecvPtr =
+                &mRecvVec[(horStencil_[jnode0][jh]*nz_+verStencil_[k0][jv])*nf];
+              for (size_t jf = 0; jf < nf; ++jf) {
+                modelVec[jf] += w*mRecvPtr[jf];
+              }
+            }
+          }
+          for (size_t jf = 0; jf < nf; ++jf) {
+            modelViews[jf](jnode0, k0) = modelVec[jf];
           }
         }
       }
@@ -1348,57 +1917,76 @@ void LayerBase::interpolationTL(const atlas::Field & redField,
 
 // -----------------------------------------------------------------------------
 
-void LayerBase::interpolationAD(const atlas::Field & modelField,
-                                atlas::Field & redField) const {
+void LayerBase::interpolationAD(const std::vector<atlas::Field> & modelFields,
+                                std::vector<atlas::Field> & redFields) const {
   oops::Log::trace() << classname() << "::interpolationAD starting" << std::endl;
 
+  // Number of fields
+  const size_t nf = modelFields.size();
+  ASSERT(redFields.size() == nf);
+
   // Initialization
-  const auto modelView = atlas::array::make_view<double, 2>(modelField);
-  auto redView = atlas::array::make_view<double, 2>(redField);
-  redView.assign(0.0);
+  std::vector<atlas::array::ArrayView<double, 2>> modelViews;
+  std::vector<atlas::array::ArrayView<double, 2>> redViews;
+  for (size_t jf = 0; jf < nf; ++jf) {
+    modelViews.push_back(atlas::array::make_view<double, 2>(modelFields[jf]));
+    redViews.push_back(atlas::array::make_view<double, 2>(redFields[jf]));
+    redViews[jf].assign(0.0);
+  }
 
   // Ghost points
   const auto ghostView = atlas::array::make_view<int, 1>(gdata_.functionSpace().ghost());
 
   if (noInterp_) {
     // No interpolation
-    for (size_t jnode0 = 0; jnode0 < mSize_; ++jnode0) {
-      if (ghostView(jnode0) == 0) {
-        for (size_t k0 = 0; k0 < nz0_; ++k0) {
-          for (size_t jv = 0; jv < verStencilSize_[k0]; ++jv) {
-            redView(jnode0, verStencil_[k0][jv]) += verWeights_[k0][jv]*modelView(jnode0, k0);
+    for (size_t jf = 0; jf < nf; ++jf) {
+      for (size_t jnode0 = 0; jnode0 < mSize_; ++jnode0) {
+        if (ghostView(jnode0) == 0) {
+          for (size_t k0 = 0; k0 < nz0_; ++k0) {
+            for (size_t jv = 0; jv < verStencilSize_[k0]; ++jv) {
+              redViews[jf](jnode0, verStencil_[k0][jv]) += verWeights_[k0][jv]
+                *modelViews[jf](jnode0, k0);
+            }
           }
         }
       }
     }
   } else {
-    // Scale counts and displs for all levels
+    // Scale counts and displs for all levels and fields
+    const size_t nzf = nz_*nf;
     std::vector<int> rSendCounts3D(comm_.size());
     std::vector<int> rSendDispls3D(comm_.size());
     std::vector<int> mRecvCounts3D(comm_.size());
     std::vector<int> mRecvDispls3D(comm_.size());
     for (size_t jt = 0; jt < comm_.size(); ++jt) {
-      rSendCounts3D[jt] = rSendCounts_[jt]*nz_;
-      rSendDispls3D[jt] = rSendDispls_[jt]*nz_;
-      mRecvCounts3D[jt] = mRecvCounts_[jt]*nz_;
-      mRecvDispls3D[jt] = mRecvDispls_[jt]*nz_;
+      rSendCounts3D[jt] = rSendCounts_[jt]*nzf;
+      rSendDispls3D[jt] = rSendDispls_[jt]*nzf;
+      mRecvCounts3D[jt] = mRecvCounts_[jt]*nzf;
+      mRecvDispls3D[jt] = mRecvDispls_[jt]*nzf;
     }
 
-    // Interpolation adjoint
-    std::vector<double> mRecvVec(mRecvSize_*nz_, 0.0);
+    // Interpolation adjoint, with fields as the innermost dimension
+    std::vector<double> mRecvVec(mRecvSize_*nzf, 0.0);
+    std::vector<double> modelVec(nf);
     for (size_t jnode0 = 0; jnode0 < mSize_; ++jnode0) {
       for (size_t jh = 0; jh < horStencilSize_[jnode0]; ++jh) {
         for (size_t k0 = 0; k0 < nz0_; ++k0) {
+          for (size_t jf = 0; jf < nf; ++jf) {
+            modelVec[jf] = modelViews[jf](jnode0, k0);
+          }
           for (size_t jv = 0; jv < verStencilSize_[k0]; ++jv) {
-            const size_t mIndex = horStencil_[jnode0][jh]*nz_+verStencil_[k0][jv];
-            mRecvVec[mIndex] += horWeights_[jnode0][jh]*verWeights_[k0][jv]*modelView(jnode0, k0);
+            const double w = horWeights_[jnode0][jh]*verWeights_[k0][jv];
+            double * mRecvPtr = &mRecvVec[(horStencil_[jnode0][jh]*nz_+verStencil_[k0][jv])*nf];
+            for (size_t jf = 0; jf < nf; ++jf) {
+              mRecvPtr[jf] += w*modelVec[jf];
+            }
           }
         }
       }
     }
 
     // Communication
-    std::vector<double> rSendVec(rSendSize_*nz_);
+    std::vector<double> rSendVec(rSendSize_*nzf);
     comm_.allToAllv(mRecvVec.data(), mRecvCounts3D.data(), mRecvDispls3D.data(),
       rSendVec.data(), rSendCounts3D.data(), rSendDispls3D.data());
 
@@ -1406,7 +1994,9 @@ void LayerBase::interpolationAD(const atlas::Field & modelField,
     for (size_t js = 0; js < rSendSize_; ++js) {
       const size_t jnode = rSendMapping_[js];
       for (size_t k = 0; k < nz_; ++k) {
-        redView(jnode, k) += rSendVec[js*nz_+k];
+        for (size_t jf = 0; jf < nf; ++jf) {
+          redViews[jf](jnode, k) += rSendVec[(js*nz_+k)*nf+jf];
+        }
       }
     }
   }
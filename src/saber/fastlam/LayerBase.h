@@ -62,14 +62,15 @@ class LayerBase : public util::Printable,
                                   std::vector<double> &,
                                   std::vector<double> &) = 0;
 
-  // Multiply square-root and adjoint
+  // Multiply square-root and adjoint, on reduced grid
   virtual size_t ctlVecSize() const = 0;
-  virtual void multiplySqrt(const atlas::Field &,
-                            atlas::Field &,
-                            const size_t &) const = 0;
-  virtual void multiplySqrtTrans(const atlas::Field &,
+  virtual void ctlVecIndices(std::vector<size_t> &) const = 0;
+  virtual void multiplySqrtOnRed(const atlas::Field &,
                                  atlas::Field &,
                                  const size_t &) const = 0;
+  virtual void multiplySqrtTransOnRed(atlas::Field &,
+                                      atlas::Field &,
+                                      const size_t &) const = 0;
 
   // Non-virtual methods
 
@@ -81,6 +82,22 @@ class LayerBase : public util::Printable,
   void setupKernels();
   void setupNormalization();
 
+  // Multiply square-root and adjoint, single field
+  void multiplySqrt(const atlas::Field &,
+                    atlas::Field &,
+                    const size_t &) const;
+  void multiplySqrtTrans(const atlas::Field &,
+                         atlas::Field &,
+                         const size_t &) const;
+
+  // Multiply square-root and adjoint, several fields sharing a single interpolation exchange
+  void multiplySqrt(const atlas::Field &,
+                    std::vector<atlas::Field> &,
+                    const size_t &) const;
+  void multiplySqrtTrans(const std::vector<atlas::Field> &,
+                         atlas::Field &,
+                         const size_t &) const;
+
   // I/O
   void read(const int &);
   void broadcast();
@@ -103,9 +120,21 @@ class LayerBase : public util::Printable,
   const atlas::FieldSet & normAcc() const {return normAcc_;}
 
  protected:
+  // Exact normalization
+  void exactNormalizationBruteForce(atlas::Field &);
+  void exactNormalizationBatched(atlas::Field &);
+  void exactNormalizationRandomized(atlas::Field &, double &);
+  void sortModelIndices(std::vector<int> &, std::vector<size_t> &) const;
+
+  // Reduced grid ownership
+  void setupOwnership(const std::vector<int> &);
+  void getOwners(const std::vector<int> &, std::vector<int> &) const;
+
   // Interpolations
   void interpolationTL(const atlas::Field &, atlas::Field &) const;
   void interpolationAD(const atlas::Field &, atlas::Field &) const;
+  void interpolationTL(const std::vector<atlas::Field> &, std::vector<atlas::Field> &) const;
+  void interpolationAD(const std::vector<atlas::Field> &, std::vector<atlas::Field> &) const;
 
   // Parameters
   FastLAMParametersBase params_;
@@ -162,7 +191,8 @@ class LayerBase : public util::Printable,
   size_t ny_;
   size_t rSize_;
   size_t nz_;
-  std::vector<int> mpiTask_;
+  size_t dirSize_;
+  std::vector<int> dirTask_;
   atlas::FunctionSpace fspace_;
   atlas::FieldSet fset_;
 
@@ -33,30 +33,44 @@ void LayerHalo::setupParallelization() {
   auto indexIView = atlas::array::make_view<int, 1>(fieldIndexI);
   auto indexJView = atlas::array::make_view<int, 1>(fieldIndexJ);
 
+  // Bounding box of local reduced grid points
+  int iMin = nx_;
+  int iMax = -1;
+  int jMin = ny_;
+  int jMax = -1;
+  for (size_t jnode = 0; jnode < rSize_; ++jnode) {
+    iMin = std::min(iMin, indexIView(jnode)-1);
+    iMax = std::max(iMax, indexIView(jnode)-1);
+    jMin = std::min(jMin, indexJView(jnode)-1);
+    jMax = std::max(jMax, indexJView(jnode)-1);
+  }
+
   // Rows convolution
 
-  // Initialize halo mask
-  atlas::Field xcPoints("xcPoints", atlas::array::make_datatype<int>(),
-    atlas::array::make_shape(nx_, ny_));
-  auto xcPointsView = atlas::array::make_view<int, 2>(xcPoints);
-  xcPointsView.assign(-2);
+  // Initialize halo mask on the local bounding box, extended along x
+  const int xcHalf = (xKernelSize_-1)/2;
+  const int xcIStart = std::max(iMin-xcHalf, 0);
+  const int xcJStart = jMin;
+  const size_t xcNi = iMax > -1 ? std::min(iMax+xcHalf, static_cast<int>(nx_)-1)-xcIStart+1 : 0;
+  const size_t xcNj = jMax > -1 ? jMax-jMin+1 : 0;
+  std::vector<int> xcPoints(xcNi*xcNj, -2);
   for (size_t jnode = 0; jnode < rSize_; ++jnode) {
     int i = indexIView(jnode)-1;
     int j = indexJView(jnode)-1;
     for (size_t jk = 0; jk < xKernelSize_; ++jk) {
       size_t ii = i-jk+(xKernelSize_-1)/2;
       if (ii >= 0 && ii < nx_) {
-        xcPointsView(ii, j) = -1;
+        xcPoints[(ii-xcIStart)*xcNj+j-xcJStart] = -1;
       }
     }
   }
 
   // Set indices
   xcSize_ = 0;
-  for (size_t j = 0; j < ny_; ++j) {
-    for (size_t i = 0; i < nx_; ++i) {
-      if (xcPointsView(i, j) == -1) {
-        xcPointsView(i, j) = xcSize_;
+  for (size_t jb = 0; jb < xcNj; ++jb) {
+    for (size_t ib = 0; ib < xcNi; ++ib) {
+      if (xcPoints[ib*xcNj+jb] == -1) {
+        xcPoints[ib*xcNj+jb] = xcSize_;
         ++xcSize_;
       }
     }
@@ -66,14 +80,18 @@ void LayerHalo::setupParallelization() {
   xcRecvCounts_.resize(comm_.size());
   std::fill(xcRecvCounts_.begin(), xcRecvCounts_.end(), 0);
   std::vector<int> xcRecvPointsList;
-  for (size_t j = 0; j < ny_; ++j) {
-    for (size_t i = 0; i < nx_; ++i) {
-      if (xcPointsView(i, j) >= 0) {
-        ++xcRecvCounts_[mpiTask_[i*ny_+j]];
-        xcRecvPointsList.push_back(i*ny_+j);
+  for (size_t jb = 0; jb < xcNj; ++jb) {
+    for (size_t ib = 0; ib < xcNi; ++ib) {
+      if (xcPoints[ib*xcNj+jb] >= 0) {
+        xcRecvPointsList.push_back((ib+xcIStart)*ny_+jb+xcJStart);
       }
     }
   }
+  std::vector<int> xcRecvTasks;
+  getOwners(xcRecvPointsList, xcRecvTasks);
+  for (const auto & jt : xcRecvTasks) {
+    ++xcRecvCounts_[jt];
+  }
 
   // Buffer size
   xcRecvSize_ = 0;
@@ -110,7 +128,7 @@ void LayerHalo::setupParallelization() {
   std::vector<int> xcRecvPointsListOrdered(xcRecvSize_);
   std::vector<int> xcRecvMapping(xcRecvSize_);
   for (size_t jr = 0; jr < xcRecvSize_; ++jr) {
-    size_t jt = mpiTask_[xcRecvPointsList[jr]];
+    size_t jt = xcRecvTasks[jr];
     size_t jro = xcRecvDispls_[jt]+xcRecvOffset[jt];
     xcRecvPointsListOrdered[jro] = xcRecvPointsList[jr];
     xcRecvMapping[jr] = jro;
@@ -144,7 +162,7 @@ void LayerHalo::setupParallelization() {
       if (ii >= 0 && ii < nx_) {
         Convolution op;
         op.row_ = jnode;
-        op.col_ = xcRecvMapping[xcPointsView(ii, j)];
+        op.col_ = xcRecvMapping[xcPoints[(ii-xcIStart)*xcNj+j-xcJStart]];
         op.S_ = xKernel_[jk];
         xcOperations_.push_back(op);
       }
@@ -153,28 +171,30 @@ void LayerHalo::setupParallelization() {
 
   // Columns convolution
 
-  // Initialize halo mask
-  atlas::Field ycPoints("ycPoints", atlas::array::make_datatype<int>(),
-    atlas::array::make_shape(nx_, ny_));
-  auto ycPointsView = atlas::array::make_view<int, 2>(ycPoints);
-  ycPointsView.assign(-2);
+  // Initialize halo mask on the local bounding box, extended along y
+  const int ycHalf = (yKernelSize_-1)/2;
+  const int ycIStart = iMin;
+  const int ycJStart = std::max(jMin-ycHalf, 0);
+  const size_t ycNi = iMax > -1 ? iMax-iMin+1 : 0;
+  const size_t ycNj = jMax > -1 ? std::min(jMax+ycHalf, static_cast<int>(ny_)-1)-ycJStart+1 : 0;
+  std::vector<int> ycPoints(ycNi*ycNj, -2);
   for (size_t jnode = 0; jnode < rSize_; ++jnode) {
     int i = indexIView(jnode)-1;
     int j = indexJView(jnode)-1;
     for (size_t jk = 0; jk < yKernelSize_; ++jk) {
       size_t jj = j-jk+(yKernelSize_-1)/2;
       if (jj >= 0 && jj < ny_) {
-        ycPointsView(i, jj) = -1;
+        ycPoints[(i-ycIStart)*ycNj+jj-ycJStart] = -1;
       }
     }
   }
 
   // Set indices
   ycSize_ = 0;
-  for (size_t j = 0; j < ny_; ++j) {
-    for (size_t i = 0; i < nx_; ++i) {
-      if (ycPointsView(i, j) == -1) {
-        ycPointsView(i, j) = ycSize_;
+  for (size_t jb = 0; jb < ycNj; ++jb) {
+    for (size_t ib = 0; ib < ycNi; ++ib) {
+      if (ycPoints[ib*ycNj+jb] == -1) {
+        ycPoints[ib*ycNj+jb] = ycSize_;
         ++ycSize_;
       }
     }
@@ -184,14 +204,18 @@ void LayerHalo::setupParallelization() {
   ycRecvCounts_.resize(comm_.size());
   std::fill(ycRecvCounts_.begin(), ycRecvCounts_.end(), 0);
   std::vector<int> ycRecvPointsList;
-  for (size_t j = 0; j < ny_; ++j) {
-    for (size_t i = 0; i < nx_; ++i) {
-      if (ycPointsView(i, j) >= 0) {
-        ++ycRecvCounts_[mpiTask_[i*ny_+j]];
-        ycRecvPointsList.push_back(i*ny_+j);
+  for (size_t jb = 0; jb < ycNj; ++jb) {
+    for (size_t ib = 0; ib < ycNi; ++ib) {
+      if (ycPoints[ib*ycNj+jb] >= 0) {
+        ycRecvPointsList.push_back((ib+ycIStart)*ny_+jb+ycJStart);
       }
     }
   }
+  std::vector<int> ycRecvTasks;
+  getOwners(ycRecvPointsList, ycRecvTasks);
+  for (const auto & jt : ycRecvTasks) {
+    ++ycRecvCounts_[jt];
+  }
 
   // Buffer size
   ycRecvSize_ = 0;
@@ -228,7 +252,7 @@ void LayerHalo::setupParallelization() {
   std::vector<int> ycRecvPointsListOrdered(ycRecvSize_);
   std::vector<int> ycRecvMapping(ycRecvSize_);
   for (size_t jr = 0; jr < ycRecvSize_; ++jr) {
-    size_t jt = mpiTask_[ycRecvPointsList[jr]];
+    size_t jt = ycRecvTasks[jr];
     size_t jro = ycRecvDispls_[jt]+ycRecvOffset[jt];
     ycRecvPointsListOrdered[jro] = ycRecvPointsList[jr];
     ycRecvMapping[jr] = jro;
@@ -262,7 +286,7 @@ void LayerHalo::setupParallelization() {
       if (jj >= 0 && jj < ny_) {
         Convolution op;
         op.row_ = jnode;
-        op.col_ = ycRecvMapping[ycPointsView(i, jj)];
+        op.col_ = ycRecvMapping[ycPoints[(i-ycIStart)*ycNj+jj-ycJStart]];
         op.S_ = yKernel_[jk];
         ycOperations_.push_back(op);
       }
@@ -372,14 +396,34 @@ void LayerHalo::extractConvolution(const size_t & nxHalf,
 
 // -----------------------------------------------------------------------------
 
-void LayerHalo::multiplySqrt(const atlas::Field & cv,
-                             atlas::Field & modelField,
-                             const size_t & offset) const {
-  oops::Log::trace() << classname() << "::multiplySqrt starting" << std::endl;
+void LayerHalo::ctlVecIndices(std::vector<size_t> & indices) const {
+  oops::Log::trace() << classname() << "::ctlVecIndices starting" << std::endl;
 
-  // Create field on reduced grid
-  atlas::Field redField = fspace_.createField<double>(atlas::option::name("dummy") |
-    atlas::option::levels(nz_));
+  // Get index fields
+  const auto indexIView = atlas::array::make_view<int, 1>(fset_["index_i"]);
+  const auto indexJView = atlas::array::make_view<int, 1>(fset_["index_j"]);
+
+  // Global index of each control vector element, in the control vector order
+  indices.resize(ctlVecSize());
+  size_t index = 0;
+  for (size_t jnode = 0; jnode < rSize_; ++jnode) {
+    const size_t i = indexIView(jnode)-1;
+    const size_t j = indexJView(jnode)-1;
+    for (size_t k = 0; k < nz_; ++k) {
+      indices[index] = (i*ny_+j)*nz_+k;
+      ++index;
+    }
+  }
+
+  oops::Log::trace() << classname() << "::ctlVecIndices done" << std::endl;
+}
+
+// -----------------------------------------------------------------------------
+
+void LayerHalo::multiplySqrtOnRed(const atlas::Field & cv,
+                                  atlas::Field & redField,
+                                  const size_t & offset) const {
+  oops::Log::trace() << classname() << "::multiplySqrtOnRed starting" << std::endl;
 
   // Control vector to reduced grid
   const auto cvView = atlas::array::make_view<double, 1>(cv);
@@ -395,25 +439,15 @@ void LayerHalo::multiplySqrt(const atlas::Field & cv,
   // Square-root multiplication on reduced grid
   multiplyRedSqrt(redField);
 
-  // Interpolation TL
-  interpolationTL(redField, modelField);
-
-  oops::Log::trace() << classname() << "::multiplySqrt done" << std::endl;
+  oops::Log::trace() << classname() << "::multiplySqrtOnRed done" << std::endl;
 }
 
 // -----------------------------------------------------------------------------
 
-void LayerHalo::multiplySqrtTrans(const atlas::Field & modelField,
-                                  atlas::Field & cv,
-                                  const size_t & offset) const {
-  oops::Log::trace() << classname() << "::multiplySqrtTrans starting" << std::endl;
-
-  // Create field on reduced grid
-  atlas::Field redField = fspace_.createField<double>(atlas::option::name("dummy") |
-    atlas::option::levels(nz_));
-
-  // Interpolation AD
-  interpolationAD(modelField, redField);
+void LayerHalo::multiplySqrtTransOnRed(atlas::Field & redField,
+                                       atlas::Field & cv,
+                                       const size_t & offset) const {
+  oops::Log::trace() << classname() << "::multiplySqrtTransOnRed starting" << std::endl;
 
   // Adjoint square-root multiplication on reduced grid
   multiplyRedSqrtTrans(redField);
@@ -429,7 +463,7 @@ void LayerHalo::multiplySqrtTrans(const atlas::Field & modelField,
     }
   }
 
-  oops::Log::trace() << classname() << "::multiplySqrtTrans done" << std::endl;
+  oops::Log::trace() << classname() << "::multiplySqrtTransOnRed done" << std::endl;
 }
 
 // -----------------------------------------------------------------------------
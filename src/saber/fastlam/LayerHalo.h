@@ -50,12 +50,13 @@ class LayerHalo : public LayerBase {
 
   // Multiply square-root and adjoint
   size_t ctlVecSize() const override {return rSize_*nz_;};
-  void multiplySqrt(const atlas::Field &,
-                    atlas::Field &,
-                    const size_t &) const override;
-  void multiplySqrtTrans(const atlas::Field &,
+  void ctlVecIndices(std::vector<size_t> &) const override;
+  void multiplySqrtOnRed(const atlas::Field &,
                          atlas::Field &,
                          const size_t &) const override;
+  void multiplySqrtTransOnRed(atlas::Field &,
+                              atlas::Field &,
+                              const size_t &) const override;
 
  private:
   void print(std::ostream &) const override;
@@ -9,11 +9,13 @@
 
 #include <algorithm>
 #include <utility>
+#include <vector>
 
 #include "atlas/array.h"
 
 #include "oops/util/Logger.h"
 #include "oops/util/missingValues.h"
+#include "oops/util/Timer.h"
 
 namespace saber {
 namespace fastlam {
@@ -400,10 +402,30 @@ void LayerRC::extractConvolution(const size_t & nxHalf,
 
 // -----------------------------------------------------------------------------
 
-void LayerRC::multiplySqrt(const atlas::Field & cv,
-                           atlas::Field & modelField,
-                           const size_t & offset) const {
-  oops::Log::trace() << classname() << "::multiplySqrt starting" << std::endl;
+void LayerRC::ctlVecIndices(std::vector<size_t> & indices) const {
+  oops::Log::trace() << classname() << "::ctlVecIndices starting" << std::endl;
+
+  // Global index of each control vector element, in the control vector order
+  indices.resize(ctlVecSize());
+  size_t index = 0;
+  for (size_t i = 0; i < nxPerTask_[myrank_]; ++i) {
+    for (size_t j = 0; j < ny_; ++j) {
+      for (size_t k = 0; k < nz_; ++k) {
+        indices[index] = ((nxStart_[myrank_]+i)*ny_+j)*nz_+k;
+        ++index;
+      }
+    }
+  }
+
+  oops::Log::trace() << classname() << "::ctlVecIndices done" << std::endl;
+}
+
+// -----------------------------------------------------------------------------
+
+void LayerRC::multiplySqrtOnRed(const atlas::Field & cv,
+                                atlas::Field & redField,
+                                const size_t & offset) const {
+  oops::Log::trace() << classname() << "::multiplySqrtOnRed starting" << std::endl;
 
   // Create field on columns
   atlas::Field colsField("dummy", atlas::array::make_datatype<double>(),
@@ -422,32 +444,18 @@ void LayerRC::multiplySqrt(const atlas::Field & cv,
     }
   }
 
-  // Create field on reduced grid
-  atlas::Field redField = fspace_.createField<double>(atlas::option::name("dummy") |
-    atlas::option::levels(nz_));
-
   // Square-root multiplication on reduced grid
   multiplyRedSqrt(colsField, redField);
 
-  // Interpolation TL
-  interpolationTL(redField, modelField);
-
-  oops::Log::trace() << classname() << "::multiplySqrt done" << std::endl;
+  oops::Log::trace() << classname() << "::multiplySqrtOnRed done" << std::endl;
 }
 
 // -----------------------------------------------------------------------------
 
-void LayerRC::multiplySqrtTrans(const atlas::Field & modelField,
-                                atlas::Field & cv,
-                                const size_t & offset) const {
-  oops::Log::trace() << classname() << "::multiplySqrtTrans starting" << std::endl;
-
-  // Create field on reduced grid
-  atlas::Field redField = fspace_.createField<double>(atlas::option::name("dummy") |
-    atlas::option::levels(nz_));
-
-  // Interpolation AD
-  interpolationAD(modelField, redField);
+void LayerRC::multiplySqrtTransOnRed(atlas::Field & redField,
+                                     atlas::Field & cv,
+                                     const size_t & offset) const {
+  oops::Log::trace() << classname() << "::multiplySqrtTransOnRed starting" << std::endl;
 
   // Create field on columns
   atlas::Field colsField("dummy", atlas::array::make_datatype<double>(),
@@ -469,7 +477,7 @@ void LayerRC::multiplySqrtTrans(const atlas::Field & modelField,
     }
   }
 
-  oops::Log::trace() << classname() << "::multiplySqrtTrans done" << std::endl;
+  oops::Log::trace() << classname() << "::multiplySqrtTransOnRed done" << std::endl;
 }
 
 // -----------------------------------------------------------------------------
@@ -574,23 +582,282 @@ void LayerRC::rowsToRed(const atlas::Field & rowsField,
 
 // -----------------------------------------------------------------------------
 
-void LayerRC::rowsConvolution(atlas::Field & field) const {
-  oops::Log::trace() << classname() << "::rowsConvolution starting" << std::endl;
+void LayerRC::startTranspose(const std::vector<int> & sendCounts,
+                             const std::vector<int> & sendDispls,
+                             const std::vector<int> & recvCounts,
+                             const std::vector<int> & recvDispls,
+                             const int & tag,
+                             Transpose & transpose) const {
+  oops::Log::trace() << classname() << "::startTranspose starting" << std::endl;
+
+  // Number of levels in the chunk
+  const size_t nzc = transpose.kEnd_-transpose.kBegin_;
+
+  // Receive buffer
+  transpose.recvVec_.resize((recvDispls[comm_.size()-1]+recvCounts[comm_.size()-1])*nzc);
+
+  // Post receives, then sends
+  transpose.requests_.clear();
+  for (size_t jt = 0; jt < comm_.size(); ++jt) {
+    if (recvCounts[jt] > 0) {
+      transpose.requests_.push_back(comm_.iReceive(transpose.recvVec_.data()+recvDispls[jt]*nzc,
+        recvCounts[jt]*nzc, jt, tag));
+    }
+  }
+  for (size_t jt = 0; jt < comm_.size(); ++jt) {
+    if (sendCounts[jt] > 0) {
+      transpose.requests_.push_back(comm_.iSend(transpose.sendVec_.data()+sendDispls[jt]*nzc,
+        sendCounts[jt]*nzc, jt, tag));
+    }
+  }
+
+  oops::Log::trace() << classname() << "::startTranspose done" << std::endl;
+}
+
+// -----------------------------------------------------------------------------
+
+void LayerRC::redToRowsStart(const atlas::Field & redField,
+                             const size_t & kBegin,
+                             const size_t & kEnd,
+                             Transpose & transpose) const {
+  oops::Log::trace() << classname() << "::redToRowsStart starting" << std::endl;
+
+  // Serialize
+  const size_t nzc = kEnd-kBegin;
+  transpose.kBegin_ = kBegin;
+  transpose.kEnd_ = kEnd;
+  transpose.sendVec_.resize(rRecvSize_*nzc);
+  const auto redView = atlas::array::make_view<double, 2>(redField);
+  for (size_t jnode = 0; jnode < rSize_; ++jnode) {
+    for (size_t k = 0; k < nzc; ++k) {
+      const size_t jv = (rRecvDispls_[xTask_[jnode]] + xOffset_[jnode])*nzc + k;
+      transpose.sendVec_[jv] = redView(jnode, kBegin+k);
+    }
+  }
+
+  // Start communication
+  startTranspose(rRecvCounts_, rRecvDispls_, xSendCounts_, xSendDispls_,
+    static_cast<int>(kBegin), transpose);
+
+  oops::Log::trace() << classname() << "::redToRowsStart done" << std::endl;
+}
+
+// -----------------------------------------------------------------------------
+
+void LayerRC::redToRowsFinish(Transpose & transpose,
+                              atlas::Field & rowsField) const {
+  oops::Log::trace() << classname() << "::redToRowsFinish starting" << std::endl;
+
+  // Wait for communication
+  comm_.waitAll(transpose.requests_);
+
+  // Deserialize
+  const size_t nzc = transpose.kEnd_-transpose.kBegin_;
+  auto rowsView = atlas::array::make_view<double, 3>(rowsField);
+  for (size_t jx = 0; jx < xSendSize_; ++jx) {
+    const size_t i = xIndex_i_[jx];
+    const size_t j = xIndex_j_[jx]-nyStart_[myrank_];
+    for (size_t k = 0; k < nzc; ++k) {
+      rowsView(i, j, transpose.kBegin_+k) = transpose.recvVec_[jx*nzc + k];
+    }
+  }
+
+  oops::Log::trace() << classname() << "::redToRowsFinish done" << std::endl;
+}
+
+// -----------------------------------------------------------------------------
+
+void LayerRC::rowsToRedStart(const atlas::Field & rowsField,
+                             const size_t & kBegin,
+                             const size_t & kEnd,
+                             Transpose & transpose) const {
+  oops::Log::trace() << classname() << "::rowsToRedStart starting" << std::endl;
+
+  // Serialize
+  const size_t nzc = kEnd-kBegin;
+  transpose.kBegin_ = kBegin;
+  transpose.kEnd_ = kEnd;
+  transpose.sendVec_.resize(xSendSize_*nzc);
+  const auto rowsView = atlas::array::make_view<double, 3>(rowsField);
+  for (size_t jx = 0; jx < xSendSize_; ++jx) {
+    const size_t i = xIndex_i_[jx];
+    const size_t j = xIndex_j_[jx]-nyStart_[myrank_];
+    for (size_t k = 0; k < nzc; ++k) {
+      transpose.sendVec_[jx*nzc + k] = rowsView(i, j, kBegin+k);
+    }
+  }
+
+  // Start communication
+  startTranspose(xSendCounts_, xSendDispls_, rRecvCounts_, rRecvDispls_,
+    static_cast<int>(nz_+kBegin), transpose);
+
+  oops::Log::trace() << classname() << "::rowsToRedStart done" << std::endl;
+}
+
+// -----------------------------------------------------------------------------
+
+void LayerRC::rowsToRedFinish(Transpose & transpose,
+                              atlas::Field & redField) const {
+  oops::Log::trace() << classname() << "::rowsToRedFinish starting" << std::endl;
+
+  // Wait for communication
+  comm_.waitAll(transpose.requests_);
+
+  // Deserialize
+  const size_t nzc = transpose.kEnd_-transpose.kBegin_;
+  auto redView = atlas::array::make_view<double, 2>(redField);
+  for (size_t jnode = 0; jnode < rSize_; ++jnode) {
+    for (size_t k = 0; k < nzc; ++k) {
+      const size_t jv = (rRecvDispls_[xTask_[jnode]] + xOffset_[jnode])*nzc + k;
+      redView(jnode, transpose.kBegin_+k) = transpose.recvVec_[jv];
+    }
+  }
+
+  oops::Log::trace() << classname() << "::rowsToRedFinish done" << std::endl;
+}
+
+// -----------------------------------------------------------------------------
 
-  // Copy field
-  atlas::Field copyField = field.clone();
-  const auto copyView = atlas::array::make_view<double, 3>(copyField);
+void LayerRC::rowsToColsStart(const atlas::Field & rowsField,
+                              const size_t & kBegin,
+                              const size_t & kEnd,
+                              Transpose & transpose) const {
+  oops::Log::trace() << classname() << "::rowsToColsStart starting" << std::endl;
 
-  // Apply kernel
+  // Serialize
+  const size_t nzc = kEnd-kBegin;
+  transpose.kBegin_ = kBegin;
+  transpose.kEnd_ = kEnd;
+  transpose.sendVec_.resize(xRecvSize_*nzc);
+  const auto rowsView = atlas::array::make_view<double, 3>(rowsField);
+  for (size_t i = 0; i < nx_; ++i) {
+    for (size_t j = 0; j < nyPerTask_[myrank_]; ++j) {
+      for (size_t k = 0; k < nzc; ++k) {
+        const size_t jv = (xRecvDispls_[yTask_[j][i]] + yOffset_[j][i])*nzc + k;
+        transpose.sendVec_[jv] = rowsView(i, j, kBegin+k);
+      }
+    }
+  }
+
+  // Start communication
+  startTranspose(xRecvCounts_, xRecvDispls_, ySendCounts_, ySendDispls_,
+    static_cast<int>(nz_+kBegin), transpose);
+
+  oops::Log::trace() << classname() << "::rowsToColsStart done" << std::endl;
+}
+
+// -----------------------------------------------------------------------------
+
+void LayerRC::rowsToColsFinish(Transpose & transpose,
+                               atlas::Field & colsField) const {
+  oops::Log::trace() << classname() << "::rowsToColsFinish starting" << std::endl;
+
+  // Wait for communication
+  comm_.waitAll(transpose.requests_);
+
+  // Deserialize
+  const size_t nzc = transpose.kEnd_-transpose.kBegin_;
+  auto colsView = atlas::array::make_view<double, 3>(colsField);
+  for (size_t jy = 0; jy < ySendSize_; ++jy) {
+    const size_t i = yIndex_i_[jy]-nxStart_[myrank_];
+    const size_t j = yIndex_j_[jy];
+    for (size_t k = 0; k < nzc; ++k) {
+      colsView(i, j, transpose.kBegin_+k) = transpose.recvVec_[jy*nzc + k];
+    }
+  }
+
+  oops::Log::trace() << classname() << "::rowsToColsFinish done" << std::endl;
+}
+
+// -----------------------------------------------------------------------------
+
+void LayerRC::colsToRowsStart(const atlas::Field & colsField,
+                              const size_t & kBegin,
+                              const size_t & kEnd,
+                              Transpose & transpose) const {
+  oops::Log::trace() << classname() << "::colsToRowsStart starting" << std::endl;
+
+  // Serialize
+  const size_t nzc = kEnd-kBegin;
+  transpose.kBegin_ = kBegin;
+  transpose.kEnd_ = kEnd;
+  transpose.sendVec_.resize(ySendSize_*nzc);
+  const auto colsView = atlas::array::make_view<double, 3>(colsField);
+  for (size_t jy = 0; jy < ySendSize_; ++jy) {
+    const size_t i = yIndex_i_[jy]-nxStart_[myrank_];
+    const size_t j = yIndex_j_[jy];
+    for (size_t k = 0; k < nzc; ++k) {
+      transpose.sendVec_[jy*nzc + k] = colsView(i, j, kBegin+k);
+    }
+  }
+
+  // Start communication
+  startTranspose(ySendCounts_, ySendDispls_, xRecvCounts_, xRecvDispls_,
+    static_cast<int>(kBegin), transpose);
+
+  oops::Log::trace() << classname() << "::colsToRowsStart done" << std::endl;
+}
+
+// -----------------------------------------------------------------------------
+
+void LayerRC::colsToRowsFinish(Transpose & transpose,
+                               atlas::Field & rowsField) const {
+  oops::Log::trace() << classname() << "::colsToRowsFinish starting" << std::endl;
+
+  // Wait for communication
+  comm_.waitAll(transpose.requests_);
+
+  // Deserialize
+  const size_t nzc = transpose.kEnd_-transpose.kBegin_;
+  auto rowsView = atlas::array::make_view<double, 3>(rowsField);
+  for (size_t i = 0; i < nx_; ++i) {
+    for (size_t j = 0; j < nyPerTask_[myrank_]; ++j) {
+      for (size_t k = 0; k < nzc; ++k) {
+        const size_t jv = (xRecvDispls_[yTask_[j][i]] + yOffset_[j][i])*nzc + k;
+        rowsView(i, j, transpose.kBegin_+k) = transpose.recvVec_[jv];
+      }
+    }
+  }
+
+  oops::Log::trace() << classname() << "::colsToRowsFinish done" << std::endl;
+}
+
+// -----------------------------------------------------------------------------
+
+void LayerRC::rowsConvolution(atlas::Field & field,
+                              const size_t & kBegin,
+                              const size_t & kEnd) const {
+  oops::Log::trace() << classname() << "::rowsConvolution starting" << std::endl;
+  util::Timer timer(classname(), "rowsConvolution");
+
+  // Apply kernel, one row (levels kBegin to kEnd) at a time, vectorized over levels
   auto view = atlas::array::make_view<double, 3>(field);
-  view.assign(0.0);
-  for (size_t j = 0; j < nyPerTask_[myrank_]; ++j) {
-    for (size_t i = 0; i < nx_; ++i) {
-      for (size_t jk = 0; jk < xKernelSize_; ++jk) {
-        const size_t ii = i-jk+(xKernelSize_-1)/2;
-        if (ii >= 0 && ii < nx_) {
-          for (size_t k = 0; k < nz_; ++k) {
-            view(i, j, k) += copyView(ii, j, k)*xKernel_[jk];
+  const int xHalf = (xKernelSize_-1)/2;
+  const size_t nzc = kEnd-kBegin;
+  # pragma omp parallel
+  {
+    // Row copy
+    std::vector<double> row(nx_*nzc);
+
+    # pragma omp for
+    for (size_t j = 0; j < nyPerTask_[myrank_]; ++j) {
+      for (size_t i = 0; i < nx_; ++i) {
+        for (size_t k = 0; k < nzc; ++k) {
+          row[i*nzc+k] = view(i, j, kBegin+k);
+          view(i, j, kBegin+k) = 0.0;
+        }
+      }
+      for (size_t i = 0; i < nx_; ++i) {
+        // Kernel range such that ii = i-jk+xHalf is in [0, nx_)
+        const int jkMin = std::max(static_cast<int>(i)+xHalf-static_cast<int>(nx_)+1, 0);
+        const int jkMax = std::min(static_cast<int>(i)+xHalf,
+          static_cast<int>(xKernelSize_)-1);
+        double * out = &view(i, j, kBegin);
+        for (int jk = jkMin; jk <= jkMax; ++jk) {
+          const double * in = &row[(i+xHalf-jk)*nzc];
+          const double w = xKernel_[jk];
+          for (size_t k = 0; k < nzc; ++k) {
+            out[k] += in[k]*w;
           }
         }
       }
@@ -602,14 +869,16 @@ void LayerRC::rowsConvolution(atlas::Field & field) const {
 
 // -----------------------------------------------------------------------------
 
-void LayerRC::rowsNormalization(atlas::Field & field) const {
+void LayerRC::rowsNormalization(atlas::Field & field,
+                                const size_t & kBegin,
+                                const size_t & kEnd) const {
   oops::Log::trace() << classname() << "::rowsNormalization starting" << std::endl;
 
   // Apply normalization
   auto view = atlas::array::make_view<double, 3>(field);
   for (size_t j = 0; j < nyPerTask_[myrank_]; ++j) {
     for (size_t i = 0; i < xNormSize_; ++i) {
-      for (size_t k = 0; k < nz_; ++k) {
+      for (size_t k = kBegin; k < kEnd; ++k) {
         view(i, j, k) *= xNorm_[i];
         view(nx_-1-i, j, k) *= xNorm_[i];
       }
@@ -719,23 +988,40 @@ void LayerRC::colsToRows(const atlas::Field & colsField,
 
 // -----------------------------------------------------------------------------
 
-void LayerRC::colsConvolution(atlas::Field & field) const {
+void LayerRC::colsConvolution(atlas::Field & field,
+                              const size_t & kBegin,
+                              const size_t & kEnd) const {
   oops::Log::trace() << classname() << "::colsConvolution starting" << std::endl;
+  util::Timer timer(classname(), "colsConvolution");
 
-  // Copy field
-  atlas::Field copyField = field.clone();
-  const auto copyView = atlas::array::make_view<double, 3>(copyField);
-
-  // Apply kernel
+  // Apply kernel, one column (levels kBegin to kEnd) at a time, vectorized over levels
   auto view = atlas::array::make_view<double, 3>(field);
-  view.assign(0.0);
-  for (size_t i = 0; i < nxPerTask_[myrank_]; ++i) {
-    for (size_t j = 0; j < ny_; ++j) {
-      for (size_t jk = 0; jk < yKernelSize_; ++jk) {
-        const size_t jj = j-jk+(yKernelSize_-1)/2;
-        if (jj >= 0 && jj < ny_) {
-          for (size_t k = 0; k < nz_; ++k) {
-            view(i, j, k) += copyView(i, jj, k)*yKernel_[jk];
+  const int yHalf = (yKernelSize_-1)/2;
+  const size_t nzc = kEnd-kBegin;
+  # pragma omp parallel
+  {
+    // Column copy
+    std::vector<double> col(ny_*nzc);
+
+    # pragma omp for
+    for (size_t i = 0; i < nxPerTask_[myrank_]; ++i) {
+      for (size_t j = 0; j < ny_; ++j) {
+        for (size_t k = 0; k < nzc; ++k) {
+          col[j*nzc+k] = view(i, j, kBegin+k);
+          view(i, j, kBegin+k) = 0.0;
+        }
+      }
+      for (size_t j = 0; j < ny_; ++j) {
+        // Kernel range such that jj = j-jk+yHalf is in [0, ny_)
+        const int jkMin = std::max(static_cast<int>(j)+yHalf-static_cast<int>(ny_)+1, 0);
+        const int jkMax = std::min(static_cast<int>(j)+yHalf,
+          static_cast<int>(yKernelSize_)-1);
+        double * out = &view(i, j, kBegin);
+        for (int jk = jkMin; jk <= jkMax; ++jk) {
+          const double * in = &col[(j+yHalf-jk)*nzc];
+          const double w = yKernel_[jk];
+          for (size_t k = 0; k < nzc; ++k) {
+            out[k] += in[k]*w;
           }
         }
       }
@@ -747,14 +1033,16 @@ void LayerRC::colsConvolution(atlas::Field & field) const {
 
 // -----------------------------------------------------------------------------
 
-void LayerRC::colsNormalization(atlas::Field & field) const {
+void LayerRC::colsNormalization(atlas::Field & field,
+                                const size_t & kBegin,
+                                const size_t & kEnd) const {
   oops::Log::trace() << classname() << "::colsNormalization starting" << std::endl;
 
   // Apply normalization
   auto view = atlas::array::make_view<double, 3>(field);
   for (size_t i = 0; i < nxPerTask_[myrank_]; ++i) {
     for (size_t j = 0; j < yNormSize_; ++j) {
-      for (size_t k = 0; k < nz_; ++k) {
+      for (size_t k = kBegin; k < kEnd; ++k) {
         view(i, j, k) *= yNorm_[j];
         view(i, ny_-1-j, k) *= yNorm_[j];
       }
@@ -768,21 +1056,32 @@ void LayerRC::colsNormalization(atlas::Field & field) const {
 
 void LayerRC::vertConvolution(atlas::Field & field) const {
   oops::Log::trace() << classname() << "::vertConvolution starting" << std::endl;
+  util::Timer timer(classname(), "vertConvolution");
 
-  // Copy field
-  atlas::Field copyField = field.clone();
-  const auto copyView = atlas::array::make_view<double, 3>(copyField);
-
-  // Apply kernel
+  // Apply kernel, one vertical profile at a time, with the kernel loop outside the level loop
   auto view = atlas::array::make_view<double, 3>(field);
-  view.assign(0.0);
-  for (size_t i = 0; i < nxPerTask_[myrank_]; ++i) {
-    for (size_t j = 0; j < ny_; ++j) {
-      for (size_t k = 0; k < nz_; ++k) {
+  const int zHalf = (zKernelSize_-1)/2;
+  # pragma omp parallel
+  {
+    // Profile copy
+    std::vector<double> prof(nz_);
+
+    # pragma omp for
+    for (size_t i = 0; i < nxPerTask_[myrank_]; ++i) {
+      for (size_t j = 0; j < ny_; ++j) {
+        double * out = &view(i, j, 0);
+        for (size_t k = 0; k < nz_; ++k) {
+          prof[k] = out[k];
+          out[k] = 0.0;
+        }
         for (size_t jk = 0; jk < zKernelSize_; ++jk) {
-          const size_t kk = k-jk+(zKernelSize_-1)/2;
-          if (kk >= 0 && kk < nz_) {
-            view(i, j, k) += copyView(i, j, kk)*zKernel_[jk];
+          // Level range such that kk = k-jk+zHalf is in [0, nz_)
+          const int shift = zHalf-static_cast<int>(jk);
+          const int kMin = std::max(-shift, 0);
+          const int kMax = std::min(static_cast<int>(nz_)-shift, static_cast<int>(nz_));
+          const double w = zKernel_[jk];
+          for (int k = kMin; k < kMax; ++k) {
+            out[k] += prof[k+shift]*w;
           }
         }
       }
@@ -816,12 +1115,10 @@ void LayerRC::vertNormalization(atlas::Field & field) const {
 void LayerRC::multiplyRedSqrt(const atlas::Field & colsField,
                               atlas::Field & redField) const {
   oops::Log::trace() << classname() << "::multiplyRedSqrt starting" << std::endl;
+  util::Timer timer(classname(), "multiplyRedSqrt");
 
   // Create intermediate fields
   atlas::Field colsFieldTmp = colsField.clone();
-  atlas::Field rowsField("dummy",
-                         atlas::array::make_datatype<double>(),
-                         atlas::array::make_shape(nx_, nyPerTask_[myrank_], nz_));
 
   if (nz_ > 1) {
     // Apply vertical kernel
@@ -831,23 +1128,33 @@ void LayerRC::multiplyRedSqrt(const atlas::Field & colsField,
     vertNormalization(colsFieldTmp);
   }
 
-  // Apply kernel on columns
-  colsConvolution(colsFieldTmp);
+  if ((std::min(params_.transposeChunks.value(), nz_) > 1) && (comm_.size() > 1)) {
+    // Horizontal part, pipelined over chunks of levels
+    multiplyRedSqrtPipelined(colsFieldTmp, redField);
+  } else {
+    // Create intermediate field
+    atlas::Field rowsField("dummy",
+                           atlas::array::make_datatype<double>(),
+                           atlas::array::make_shape(nx_, nyPerTask_[myrank_], nz_));
 
-  // Apply normalization on columns
-  colsNormalization(colsFieldTmp);
+    // Apply kernel on columns
+    colsConvolution(colsFieldTmp, 0, nz_);
 
-  // Columns to rows
-  colsToRows(colsFieldTmp, rowsField);
+    // Apply normalization on columns
+    colsNormalization(colsFieldTmp, 0, nz_);
 
-  // Apply kernel on rows
-  rowsConvolution(rowsField);
+    // Columns to rows
+    colsToRows(colsFieldTmp, rowsField);
 
-  // Apply normalization on rows
-  rowsNormalization(rowsField);
+    // Apply kernel on rows
+    rowsConvolution(rowsField, 0, nz_);
 
-  // Rows to reduced grid
-  rowsToRed(rowsField, redField);
+    // Apply normalization on rows
+    rowsNormalization(rowsField, 0, nz_);
+
+    // Rows to reduced grid
+    rowsToRed(rowsField, redField);
+  }
 
   oops::Log::trace() << classname() << "::multiplyRedSqrt done" << std::endl;
 }
@@ -857,28 +1164,34 @@ void LayerRC::multiplyRedSqrt(const atlas::Field & colsField,
 void LayerRC::multiplyRedSqrtTrans(const atlas::Field & redField,
                                    atlas::Field & colsField) const {
   oops::Log::trace() << classname() << "::multiplyRedSqrtTrans starting" << std::endl;
+  util::Timer timer(classname(), "multiplyRedSqrtTrans");
+
+  if ((std::min(params_.transposeChunks.value(), nz_) > 1) && (comm_.size() > 1)) {
+    // Horizontal part, pipelined over chunks of levels
+    multiplyRedSqrtTransPipelined(redField, colsField);
+  } else {
+    // Create intermediate fields
+    atlas::Field rowsField("dummy", atlas::array::make_datatype<double>(),
+      atlas::array::make_shape(nx_, nyPerTask_[myrank_], nz_));
 
-  // Create intermediate fields
-  atlas::Field rowsField("dummy", atlas::array::make_datatype<double>(),
-    atlas::array::make_shape(nx_, nyPerTask_[myrank_], nz_));
-
-  // Reduced grid to rows
-  redToRows(redField, rowsField);
+    // Reduced grid to rows
+    redToRows(redField, rowsField);
 
-  // Apply normalization on rows
-  rowsNormalization(rowsField);
+    // Apply normalization on rows
+    rowsNormalization(rowsField, 0, nz_);
 
-  // Apply kernel on rows
-  rowsConvolution(rowsField);
+    // Apply kernel on rows
+    rowsConvolution(rowsField, 0, nz_);
 
-  // Rows to columns
-  rowsToCols(rowsField, colsField);
+    // Rows to columns
+    rowsToCols(rowsField, colsField);
 
-  // Apply normalization on columns
-  colsNormalization(colsField);
+    // Apply normalization on columns
+    colsNormalization(colsField, 0, nz_);
 
-  // Apply kernel on columns
-  colsConvolution(colsField);
+    // Apply kernel on columns
+    colsConvolution(colsField, 0, nz_);
+  }
 
   if (nz_ > 1) {
     // Apply vertical normalization
@@ -893,5 +1206,90 @@ void LayerRC::multiplyRedSqrtTrans(const atlas::Field & redField,
 
 // -----------------------------------------------------------------------------
 
+void LayerRC::multiplyRedSqrtPipelined(atlas::Field & colsField,
+                                       atlas::Field & redField) const {
+  oops::Log::trace() << classname() << "::multiplyRedSqrtPipelined starting" << std::endl;
+
+  // Chunks of levels
+  const size_t nChunks = std::min(params_.transposeChunks.value(), nz_);
+  std::vector<Transpose> colsToRowsChunks(nChunks);
+  std::vector<Transpose> rowsToRedChunks(nChunks);
+
+  // Create intermediate field
+  atlas::Field rowsField("dummy",
+                         atlas::array::make_datatype<double>(),
+                         atlas::array::make_shape(nx_, nyPerTask_[myrank_], nz_));
+
+  // Columns convolution of each chunk, overlapped with the transpose of the previous chunks
+  for (size_t jc = 0; jc < nChunks; ++jc) {
+    const size_t kBegin = jc*nz_/nChunks;
+    const size_t kEnd = (jc+1)*nz_/nChunks;
+    colsConvolution(colsField, kBegin, kEnd);
+    colsNormalization(colsField, kBegin, kEnd);
+    colsToRowsStart(colsField, kBegin, kEnd, colsToRowsChunks[jc]);
+  }
+
+  // Rows convolution of each received chunk, overlapped with the transposes in flight
+  for (size_t jc = 0; jc < nChunks; ++jc) {
+    colsToRowsFinish(colsToRowsChunks[jc], rowsField);
+    const size_t kBegin = colsToRowsChunks[jc].kBegin_;
+    const size_t kEnd = colsToRowsChunks[jc].kEnd_;
+    rowsConvolution(rowsField, kBegin, kEnd);
+    rowsNormalization(rowsField, kBegin, kEnd);
+    rowsToRedStart(rowsField, kBegin, kEnd, rowsToRedChunks[jc]);
+  }
+
+  // Receive reduced grid chunks
+  for (size_t jc = 0; jc < nChunks; ++jc) {
+    rowsToRedFinish(rowsToRedChunks[jc], redField);
+  }
+
+  oops::Log::trace() << classname() << "::multiplyRedSqrtPipelined done" << std::endl;
+}
+
+// -----------------------------------------------------------------------------
+
+void LayerRC::multiplyRedSqrtTransPipelined(const atlas::Field & redField,
+                                            atlas::Field & colsField) const {
+  oops::Log::trace() << classname() << "::multiplyRedSqrtTransPipelined starting" << std::endl;
+
+  // Chunks of levels
+  const size_t nChunks = std::min(params_.transposeChunks.value(), nz_);
+  std::vector<Transpose> redToRowsChunks(nChunks);
+  std::vector<Transpose> rowsToColsChunks(nChunks);
+
+  // Create intermediate field
+  atlas::Field rowsField("dummy", atlas::array::make_datatype<double>(),
+    atlas::array::make_shape(nx_, nyPerTask_[myrank_], nz_));
+
+  // Start all reduced grid to rows transposes
+  for (size_t jc = 0; jc < nChunks; ++jc) {
+    redToRowsStart(redField, jc*nz_/nChunks, (jc+1)*nz_/nChunks, redToRowsChunks[jc]);
+  }
+
+  // Rows convolution of each received chunk, overlapped with the transposes in flight
+  for (size_t jc = 0; jc < nChunks; ++jc) {
+    redToRowsFinish(redToRowsChunks[jc], rowsField);
+    const size_t kBegin = redToRowsChunks[jc].kBegin_;
+    const size_t kEnd = redToRowsChunks[jc].kEnd_;
+    rowsNormalization(rowsField, kBegin, kEnd);
+    rowsConvolution(rowsField, kBegin, kEnd);
+    rowsToColsStart(rowsField, kBegin, kEnd, rowsToColsChunks[jc]);
+  }
+
+  // Columns convolution of each received chunk, overlapped with the transposes in flight
+  for (size_t jc = 0; jc < nChunks; ++jc) {
+    rowsToColsFinish(rowsToColsChunks[jc], colsField);
+    const size_t kBegin = rowsToColsChunks[jc].kBegin_;
+    const size_t kEnd = rowsToColsChunks[jc].kEnd_;
+    colsNormalization(colsField, kBegin, kEnd);
+    colsConvolution(colsField, kBegin, kEnd);
+  }
+
+  oops::Log::trace() << classname() << "::multiplyRedSqrtTransPipelined done" << std::endl;
+}
+
+// -----------------------------------------------------------------------------
+
 }  // namespace fastlam
 }  // namespace saber
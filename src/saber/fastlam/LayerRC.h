@@ -14,6 +14,7 @@
 #include "atlas/functionspace.h"
 
 #include "eckit/exception/Exceptions.h"
+#include "eckit/mpi/Comm.h"
 
 #include "oops/base/GeometryData.h"
 
@@ -50,12 +51,13 @@ class LayerRC : public LayerBase {
 
   // Multiply square-root and adjoint
   size_t ctlVecSize() const override {return nxPerTask_[myrank_]*ny_*nz_;};
-  void multiplySqrt(const atlas::Field &,
-                    atlas::Field &,
-                    const size_t &) const override;
-  void multiplySqrtTrans(const atlas::Field &,
+  void ctlVecIndices(std::vector<size_t> &) const override;
+  void multiplySqrtOnRed(const atlas::Field &,
                          atlas::Field &,
                          const size_t &) const override;
+  void multiplySqrtTransOnRed(atlas::Field &,
+                              atlas::Field &,
+                              const size_t &) const override;
 
  private:
   void print(std::ostream &) const override;
@@ -66,19 +68,41 @@ class LayerRC : public LayerBase {
   void rowsToCols(const atlas::Field &, atlas::Field &) const;
   void colsToRows(const atlas::Field &, atlas::Field &) const;
 
+  // Nonblocking transforms on a chunk of levels
+  struct Transpose {
+    size_t kBegin_;
+    size_t kEnd_;
+    std::vector<double> sendVec_;
+    std::vector<double> recvVec_;
+    std::vector<eckit::mpi::Request> requests_;
+  };
+  void startTranspose(const std::vector<int> &, const std::vector<int> &,
+                      const std::vector<int> &, const std::vector<int> &,
+                      const int &, Transpose &) const;
+  void redToRowsStart(const atlas::Field &, const size_t &, const size_t &, Transpose &) const;
+  void redToRowsFinish(Transpose &, atlas::Field &) const;
+  void rowsToRedStart(const atlas::Field &, const size_t &, const size_t &, Transpose &) const;
+  void rowsToRedFinish(Transpose &, atlas::Field &) const;
+  void rowsToColsStart(const atlas::Field &, const size_t &, const size_t &, Transpose &) const;
+  void rowsToColsFinish(Transpose &, atlas::Field &) const;
+  void colsToRowsStart(const atlas::Field &, const size_t &, const size_t &, Transpose &) const;
+  void colsToRowsFinish(Transpose &, atlas::Field &) const;
+
   // Convolutions
-  void rowsConvolution(atlas::Field &) const;
-  void colsConvolution(atlas::Field &) const;
+  void rowsConvolution(atlas::Field &, const size_t &, const size_t &) const;
+  void colsConvolution(atlas::Field &, const size_t &, const size_t &) const;
   void vertConvolution(atlas::Field &) const;
 
   // Normalizations
-  void rowsNormalization(atlas::Field &) const;
-  void colsNormalization(atlas::Field &) const;
+  void rowsNormalization(atlas::Field &, const size_t &, const size_t &) const;
+  void colsNormalization(atlas::Field &, const size_t &, const size_t &) const;
   void vertNormalization(atlas::Field &) const;
 
   // Multiply square-root on reduced grid
   void multiplyRedSqrt(const atlas::Field &, atlas::Field &) const;
   void multiplyRedSqrtTrans(const atlas::Field &, atlas::Field &) const;
+  void multiplyRedSqrtPipelined(atlas::Field &, atlas::Field &) const;
+  void multiplyRedSqrtTransPipelined(const atlas::Field &, atlas::Field &) const;
 
   // Sizes
   std::vector<size_t> nxPerTask_;
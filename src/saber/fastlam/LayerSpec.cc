@@ -8,12 +8,16 @@
 #include "saber/fastlam/LayerSpec.h"
 
 #include <algorithm>
+#include <cstdlib>
+#include <cstring>
+#include <functional>
 #include <utility>
 
 #include "atlas/array.h"
 
 #include "oops/util/Logger.h"
 #include "oops/util/missingValues.h"
+#include "oops/util/Timer.h"
 
 namespace saber {
 namespace fastlam {
@@ -220,6 +224,39 @@ void LayerSpec::setupParallelization() {
   comm_.allToAllv(xIndex_j.data(), xRecvCounts_.data(), xRecvDispls_.data(),
     yIndex_j_.data(), ySendCounts_.data(), ySendDispls_.data());
 
+  // FFTW planning, using wisdom if available
+  const bool useWisdom = (params_.fftwWisdomFile.value() != boost::none);
+  const bool wisdomImported = useWisdom ? importWisdom() : false;
+  unsigned int flags = FFTW_PATIENT;
+  if (useWisdom) {
+    const std::string rigor = params_.fftwRigorWithoutWisdom.value();
+    if (rigor == "patient") {
+      flags = FFTW_PATIENT;
+    } else if (rigor == "measure") {
+      flags = FFTW_MEASURE;
+    } else if (rigor == "estimate") {
+      flags = FFTW_ESTIMATE;
+    } else {
+      throw eckit::UserError("wrong FFTW planning rigor: " + rigor, Here());
+    }
+  }
+  int newWisdom = 0;
+  auto plan = [&](const std::function<fftw_plan(const unsigned int &)> & planner) {
+    util::Timer timer(classname(), "fftwPlanning");
+    fftw_plan p = NULL;
+    if (wisdomImported) {
+      // Wisdom only, best rigor first
+      p = planner(FFTW_PATIENT | FFTW_WISDOM_ONLY);
+      if (p == NULL) p = planner(flags | FFTW_WISDOM_ONLY);
+    }
+    if (p == NULL) {
+      // Actual planning
+      p = planner(flags);
+      newWisdom = 1;
+    }
+    return p;
+  };
+
   // Rows FFTW setup
   int xRank = 1;
   int xN[] = {static_cast<int>(nxExt_)};
@@ -232,10 +269,10 @@ void LayerSpec::setupParallelization() {
   const int xOdist = static_cast<int>(nxExt_/2+1);
   xBufR_ = fftw_alloc_real(nxExt_*nyPerTask_[myrank_]*nz_);
   xBufC_ = fftw_alloc_complex((nxExt_/2+1)*nyPerTask_[myrank_]*nz_);
-  xPlan_r2c_ = fftw_plan_many_dft_r2c(xRank, xN, xHowmany, xBufR_, xInembed, xIstride, xIdist,
-    xBufC_, xOnembed, xOstride, xOdist, FFTW_PATIENT);
-  xPlan_c2r_ = fftw_plan_many_dft_c2r(xRank, xN, xHowmany, xBufC_, xOnembed, xOstride, xOdist,
-    xBufR_, xInembed, xIstride, xIdist, FFTW_PATIENT);
+  xPlan_r2c_ = plan([&](const unsigned int & f) {return fftw_plan_many_dft_r2c(xRank, xN, xHowmany,
+    xBufR_, xInembed, xIstride, xIdist, xBufC_, xOnembed, xOstride, xOdist, f);});
+  xPlan_c2r_ = plan([&](const unsigned int & f) {return fftw_plan_many_dft_c2r(xRank, xN, xHowmany,
+    xBufC_, xOnembed, xOstride, xOdist, xBufR_, xInembed, xIstride, xIdist, f);});
 
   // Rows normalization factor
   xNormFFT_ = 1.0/static_cast<double>(nxExt_);
@@ -243,7 +280,8 @@ void LayerSpec::setupParallelization() {
   // Rows spectral standard deviation
   double *xBufR1d = fftw_alloc_real(nxExt_);
   fftw_complex *xBufC1d = fftw_alloc_complex(nxExt_/2+1);
-  fftw_plan xPlan_r2c1d = fftw_plan_dft_r2c_1d(nxExt_, xBufR1d, xBufC1d, FFTW_PATIENT);
+  fftw_plan xPlan_r2c1d = plan([&](const unsigned int & f) {return fftw_plan_dft_r2c_1d(nxExt_,
+    xBufR1d, xBufC1d, f);});
   for (size_t i = 0; i < nxExt_; ++i) {
     if (i <= (xKernelSize_-1)/2) {
       xBufR1d[i] = xKernel_[(xKernelSize_-1)/2+i];
@@ -270,10 +308,10 @@ void LayerSpec::setupParallelization() {
   const int yOdist = static_cast<int>(nyExt_/2+1);
   yBufR_ = fftw_alloc_real(nxPerTask_[myrank_]*nyExt_*nz_);
   yBufC_ = fftw_alloc_complex(nxPerTask_[myrank_]*(nyExt_/2+1)*nz_);
-  yPlan_r2c_ = fftw_plan_many_dft_r2c(yRank, yN, yHowmany, yBufR_, yInembed, yIstride, yIdist,
-    yBufC_, yOnembed, yOstride, yOdist, FFTW_PATIENT);
-  yPlan_c2r_ = fftw_plan_many_dft_c2r(yRank, yN, yHowmany, yBufC_, yOnembed, yOstride, yOdist,
-    yBufR_, yInembed, yIstride, yIdist, FFTW_PATIENT);
+  yPlan_r2c_ = plan([&](const unsigned int & f) {return fftw_plan_many_dft_r2c(yRank, yN, yHowmany,
+    yBufR_, yInembed, yIstride, yIdist, yBufC_, yOnembed, yOstride, yOdist, f);});
+  yPlan_c2r_ = plan([&](const unsigned int & f) {return fftw_plan_many_dft_c2r(yRank, yN, yHowmany,
+    yBufC_, yOnembed, yOstride, yOdist, yBufR_, yInembed, yIstride, yIdist, f);});
 
   // Columns normalization factor
   yNormFFT_ = 1.0/static_cast<double>(nyExt_);
@@ -281,7 +319,8 @@ void LayerSpec::setupParallelization() {
   // Rows spectral standard deviation
   double *yBufR1d = fftw_alloc_real(nyExt_);
   fftw_complex *yBufC1d = fftw_alloc_complex(nyExt_/2+1);
-  fftw_plan yPlan_r2c1d = fftw_plan_dft_r2c_1d(nyExt_, yBufR1d, yBufC1d, FFTW_PATIENT);
+  fftw_plan yPlan_r2c1d = plan([&](const unsigned int & f) {return fftw_plan_dft_r2c_1d(nyExt_,
+    yBufR1d, yBufC1d, f);});
   for (size_t j = 0; j < nyExt_; ++j) {
     if (j <= (yKernelSize_-1)/2) {
       yBufR1d[j] = yKernel_[(yKernelSize_-1)/2+j];
@@ -296,6 +335,14 @@ void LayerSpec::setupParallelization() {
     ySpecStdDev_.push_back(yBufC1d[kw][0]);
   }
 
+  if (useWisdom) {
+    // Update wisdom file if any task had to plan
+    comm_.allReduceInPlace(newWisdom, eckit::mpi::max());
+    if (newWisdom == 1) {
+      exportWisdom();
+    }
+  }
+
   if (!params_.skipTests.value()) {
     // Tests
 
@@ -484,10 +531,30 @@ void LayerSpec::extractConvolution(const size_t & nxHalf,
 
 // -----------------------------------------------------------------------------
 
-void LayerSpec::multiplySqrt(const atlas::Field & cv,
-                             atlas::Field & modelField,
-                             const size_t & offset) const {
-  oops::Log::trace() << classname() << "::multiplySqrt starting" << std::endl;
+void LayerSpec::ctlVecIndices(std::vector<size_t> & indices) const {
+  oops::Log::trace() << classname() << "::ctlVecIndices starting" << std::endl;
+
+  // Global index of each control vector element, in the control vector order
+  indices.resize(ctlVecSize());
+  size_t index = 0;
+  for (size_t i = 0; i < nxPerTask_[myrank_]; ++i) {
+    for (size_t j = 0; j < nyExt_; ++j) {
+      for (size_t k = 0; k < nz_; ++k) {
+        indices[index] = ((nxStart_[myrank_]+i)*nyExt_+j)*nz_+k;
+        ++index;
+      }
+    }
+  }
+
+  oops::Log::trace() << classname() << "::ctlVecIndices done" << std::endl;
+}
+
+// -----------------------------------------------------------------------------
+
+void LayerSpec::multiplySqrtOnRed(const atlas::Field & cv,
+                                  atlas::Field & redField,
+                                  const size_t & offset) const {
+  oops::Log::trace() << classname() << "::multiplySqrtOnRed starting" << std::endl;
 
   // Create field on columns
   atlas::Field colsField("dummy", atlas::array::make_datatype<double>(),
@@ -506,32 +573,18 @@ void LayerSpec::multiplySqrt(const atlas::Field & cv,
     }
   }
 
-  // Create field on reduced grid
-  atlas::Field redField = fspace_.createField<double>(atlas::option::name("dummy") |
-    atlas::option::levels(nz_));
-
   // Square-root multiplication on reduced grid
   multiplyRedSqrt(colsField, redField);
 
-  // Interpolation TL
-  interpolationTL(redField, modelField);
-
-  oops::Log::trace() << classname() << "::multiplySqrt done" << std::endl;
+  oops::Log::trace() << classname() << "::multiplySqrtOnRed done" << std::endl;
 }
 
 // -----------------------------------------------------------------------------
 
-void LayerSpec::multiplySqrtTrans(const atlas::Field & modelField,
-                                  atlas::Field & cv,
-                                  const size_t & offset) const {
-  oops::Log::trace() << classname() << "::multiplySqrtTrans starting" << std::endl;
-
-  // Create field on reduced grid
-  atlas::Field redField = fspace_.createField<double>(atlas::option::name("dummy") |
-    atlas::option::levels(nz_));
-
-  // Interpolation AD
-  interpolationAD(modelField, redField);
+void LayerSpec::multiplySqrtTransOnRed(atlas::Field & redField,
+                                       atlas::Field & cv,
+                                       const size_t & offset) const {
+  oops::Log::trace() << classname() << "::multiplySqrtTransOnRed starting" << std::endl;
 
   // Create field on columns
   atlas::Field colsField("dummy", atlas::array::make_datatype<double>(),
@@ -553,7 +606,79 @@ void LayerSpec::multiplySqrtTrans(const atlas::Field & modelField,
     }
   }
 
-  oops::Log::trace() << classname() << "::multiplySqrtTrans done" << std::endl;
+  oops::Log::trace() << classname() << "::multiplySqrtTransOnRed done" << std::endl;
+}
+
+// -----------------------------------------------------------------------------
+
+bool LayerSpec::importWisdom() const {
+  oops::Log::trace() << classname() << "::importWisdom starting" << std::endl;
+
+  // Read wisdom file on root task
+  const std::string filePath = *params_.fftwWisdomFile.value();
+  std::vector<char> wisdom;
+  if (comm_.rank() == 0) {
+    if (fftw_import_wisdom_from_filename(filePath.c_str()) != 0) {
+      char * wisdomStr = fftw_export_wisdom_to_string();
+      wisdom.assign(wisdomStr, wisdomStr+std::strlen(wisdomStr)+1);
+      free(wisdomStr);
+    }
+  }
+
+  // Broadcast wisdom
+  size_t wisdomSize = wisdom.size();
+  comm_.broadcast(wisdomSize, 0);
+  if (wisdomSize == 0) {
+    oops::Log::info() << "Info     :     No FFTW wisdom found in " << filePath << std::endl;
+    oops::Log::trace() << classname() << "::importWisdom done" << std::endl;
+    return false;
+  }
+  wisdom.resize(wisdomSize);
+  comm_.broadcast(wisdom.begin(), wisdom.end(), 0);
+
+  // Import wisdom on other tasks
+  if (comm_.rank() > 0) {
+    if (fftw_import_wisdom_from_string(wisdom.data()) == 0) {
+      throw eckit::Exception("cannot import FFTW wisdom", Here());
+    }
+  }
+  oops::Log::info() << "Info     :     FFTW wisdom imported from " << filePath << std::endl;
+
+  oops::Log::trace() << classname() << "::importWisdom done" << std::endl;
+  return true;
+}
+
+// -----------------------------------------------------------------------------
+
+void LayerSpec::exportWisdom() const {
+  oops::Log::trace() << classname() << "::exportWisdom starting" << std::endl;
+
+  // Local wisdom (problem sizes differ between tasks)
+  char * wisdomStr = fftw_export_wisdom_to_string();
+  std::vector<char> wisdom(wisdomStr, wisdomStr+std::strlen(wisdomStr)+1);
+  free(wisdomStr);
+
+  // Gather wisdom from all tasks
+  eckit::mpi::Buffer<char> wisdomBuffer(comm_.size());
+  comm_.allGatherv(wisdom.begin(), wisdom.end(), wisdomBuffer);
+
+  if (comm_.rank() == 0) {
+    // Merge wisdom on root task
+    for (size_t jt = 1; jt < comm_.size(); ++jt) {
+      if (fftw_import_wisdom_from_string(&wisdomBuffer.buffer[wisdomBuffer.displs[jt]]) == 0) {
+        throw eckit::Exception("cannot merge FFTW wisdom", Here());
+      }
+    }
+
+    // Write wisdom file
+    const std::string filePath = *params_.fftwWisdomFile.value();
+    if (fftw_export_wisdom_to_filename(filePath.c_str()) == 0) {
+      throw eckit::Exception("cannot write FFTW wisdom file " + filePath, Here());
+    }
+    oops::Log::info() << "Info     :     FFTW wisdom exported to " << filePath << std::endl;
+  }
+
+  oops::Log::trace() << classname() << "::exportWisdom done" << std::endl;
 }
 
 // -----------------------------------------------------------------------------
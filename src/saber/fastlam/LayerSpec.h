@@ -52,12 +52,13 @@ class LayerSpec : public LayerBase {
 
   // Multiply square-root and adjoint
   size_t ctlVecSize() const override {return nxPerTask_[myrank_]*nyExt_*nz_;};
-  void multiplySqrt(const atlas::Field &,
-                    atlas::Field &,
-                    const size_t &) const override;
-  void multiplySqrtTrans(const atlas::Field &,
+  void ctlVecIndices(std::vector<size_t> &) const override;
+  void multiplySqrtOnRed(const atlas::Field &,
                          atlas::Field &,
                          const size_t &) const override;
+  void multiplySqrtTransOnRed(atlas::Field &,
+                              atlas::Field &,
+                              const size_t &) const override;
 
  private:
   void print(std::ostream &) const override;
@@ -116,6 +117,10 @@ class LayerSpec : public LayerBase {
   std::vector<int> yIndex_i_;
   std::vector<int> yIndex_j_;
 
+  // FFTW wisdom
+  bool importWisdom() const;
+  void exportWisdom() const;
+
   // Rows FFT
   fftw_plan xPlan_r2c_;
   fftw_plan xPlan_c2r_;
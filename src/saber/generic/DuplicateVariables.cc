@@ -134,12 +134,8 @@ void DuplicateVariables::multiply(oops::FieldSet3D & fset) const {
     oops::Variables v = gp.groupComponents.value();
     for (const auto & component : v) {
       const size_t nlev = activeVars_[component.name()].getLevels();
-      atlas::Field field =
-        innerGeometryData_.functionSpace()->createField<double>(
-        atlas::option::name(component.name()) | atlas::option::levels(nlev));
-      atlas::array::make_view<double, 2>(field).assign(0.0);
-      field.set_dirty(false);
-      fsetOut.add(field);
+      fsetOut.add(pooledField(innerGeometryData_.functionSpace(),
+        atlas::option::name(component.name()) | atlas::option::levels(nlev)));
     }
   }
 
@@ -172,12 +168,8 @@ void DuplicateVariables::multiplyAD(oops::FieldSet3D & fset) const {
   for (const VariableGroupParameters & gp : groups_) {
     std::string key = gp.groupVariableName.value();
     const size_t nlev = activeVars_[key].getLevels();
-    atlas::Field field =
-      innerGeometryData_.functionSpace()->createField<double>(
-        atlas::option::name(key) | atlas::option::levels(nlev));
-    atlas::array::make_view<double, 2>(field).assign(0.0);
-    field.set_dirty(false);
-    fsetOut.add(field);
+    fsetOut.add(pooledField(innerGeometryData_.functionSpace(),
+      atlas::option::name(key) | atlas::option::levels(nlev)));
   }
 
   // sum component fields into group fields
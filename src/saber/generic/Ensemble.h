@@ -49,6 +49,9 @@ class EnsembleParameters : public SaberBlockParametersBase {
   // Inflation value
   oops::Parameter<double> inflationValue{"inflation value", 1.0, this};
 
+  // Number of ensemble members localized together
+  oops::Parameter<size_t> localizationBatchSize{"localization batch size", 1, this};
+
   oops::Variables mandatoryActiveVars() const override {return oops::Variables();}
 };
 
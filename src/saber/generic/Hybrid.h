@@ -75,6 +75,10 @@ class ComponentParameters : public oops::Parameters {
 
   // Weight
   oops::RequiredParameter<WeightParameters> weight{"weight", this};
+
+  // Relative cost of the component, used to size the components with 'parallel sizing:
+  // prescribed'
+  oops::Parameter<double> relativeCost{"relative cost", 1.0, this};
 };
 
 // -----------------------------------------------------------------------------
@@ -91,6 +95,15 @@ class HybridParameters : public SaberBlockParametersBase {
   // Switch to run components in parallel
   oops::Parameter<bool> runInParallel{"run in parallel", false, this};
 
+  // Number of MPI tasks per component when running in parallel: 'equal', 'prescribed' to size
+  // the components in proportion to their 'relative cost', or 'automatic' to resize the
+  // components in proportion to their cost, measured with a warm-up application
+  oops::Parameter<std::string> parallelSizing{"parallel sizing", "equal", this};
+
+  // Minimum relative imbalance of the warm-up times ((max-min)/max) for which the components
+  // are resized with 'parallel sizing: automatic'
+  oops::Parameter<double> parallelSizingThreshold{"parallel sizing threshold", 0.2, this};
+
   oops::Variables mandatoryActiveVars() const override {return oops::Variables();}
 };
 
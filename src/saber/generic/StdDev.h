@@ -91,6 +91,7 @@ class StdDev : public SaberOuterBlockBase {
   void multiply(oops::FieldSet3D &) const override;
   void multiplyAD(oops::FieldSet3D &) const override;
   void leftInverseMultiply(oops::FieldSet3D &) const override;
+  const oops::FieldSet3D * pointwiseFactors() const override {return stdDevFset_.get();}
 
   std::vector<std::pair<std::string, eckit::LocalConfiguration>> getReadConfs() const override;
   void setReadFields(const std::vector<oops::FieldSet3D> &) override;
@@ -101,6 +102,7 @@ class StdDev : public SaberOuterBlockBase {
 
   void iterativeCalibrationInit() override;
   void iterativeCalibrationUpdate(const oops::FieldSet3D &) override;
+  bool communicationFreeCalibration() const override {return true;}
   void iterativeCalibrationFinal() override;
 
   std::vector<std::pair<eckit::LocalConfiguration, oops::FieldSet3D>> fieldsToWrite() const
@@ -390,6 +390,130 @@ void VertLoc::multiplyAD(oops::FieldSet3D & fset) const {
 
 // -----------------------------------------------------------------------------
 
+void VertLoc::multiplyBatch(std::vector<oops::FieldSet3D> & fsets) const {
+  oops::Log::trace() << classname() << "::multiplyBatch starting" << std::endl;
+
+  const size_t nb = fsets.size();
+  std::vector<atlas::FieldSet> fsetsOut(nb);
+
+  // Passive variables
+  for (size_t jb = 0; jb < nb; ++jb) {
+    for (const auto & var : fsets[jb].field_names()) {
+      if (!activeVars_.has(var)) {
+        fsetsOut[jb].add(fsets[jb][var]);
+      }
+    }
+  }
+
+  // Active variables
+  for (const auto & var : activeVars_) {
+    std::vector<atlas::array::ArrayView<double, 2>> inViews;
+    std::vector<atlas::array::ArrayView<double, 2>> outViews;
+    for (size_t jb = 0; jb < nb; ++jb) {
+      if (fsets[jb][var.name()].shape(1) != nmods_) {
+        oops::Log::error() << "Error    : Field " << var << " has "
+                           << fsets[jb][var.name()].shape(1) << ", expected " << nmods_ << ". "
+                           << std::endl;
+        throw eckit::UserError("Wrong number of vertical levels in field " + var.name(),
+                               Here());
+      }
+
+      // Create new field with nlevs_ levels
+      atlas::Field outField =
+        innerGeometryData_.functionSpace().createField<double>
+          (atlas::option::name(var.name()) |
+           atlas::option::levels(nlevs_));
+      outViews.push_back(atlas::array::make_view<double, 2>(outField));
+      outViews.back().assign(0.0);
+      inViews.push_back(atlas::array::make_view<double, 2>(fsets[jb][var.name()]));
+      fsetsOut[jb].add(outField);
+    }
+    if (nb == 0) continue;
+
+    // Apply U matrix, each element being read once for all the batch members
+    atlas_omp_parallel_for(atlas::idx_t jn = 0; jn < outViews[0].shape(0); ++jn) {
+      for (atlas::idx_t jl = 0; jl < nlevs_; ++jl) {
+        for (atlas::idx_t jm = 0; jm < nmods_; ++jm) {
+          const double u = Umatrix_(jl, jm);
+          for (size_t jb = 0; jb < nb; ++jb) {
+            outViews[jb](jn, jl) += u * inViews[jb](jn, jm);
+          }
+        }
+      }
+    }
+  }
+
+  for (size_t jb = 0; jb < nb; ++jb) {
+    fsets[jb].fieldSet() = fsetsOut[jb];
+  }
+
+  oops::Log::trace() << classname() << "::multiplyBatch done" << std::endl;
+}
+
+// -----------------------------------------------------------------------------
+
+void VertLoc::multiplyADBatch(std::vector<oops::FieldSet3D> & fsets) const {
+  oops::Log::trace() << classname() << "::multiplyADBatch starting" << std::endl;
+
+  const size_t nb = fsets.size();
+  std::vector<atlas::FieldSet> fsetsOut(nb);
+
+  // Passive variables
+  for (size_t jb = 0; jb < nb; ++jb) {
+    for (const auto & var : fsets[jb].field_names()) {
+      if (!activeVars_.has(var)) {
+        fsetsOut[jb].add(fsets[jb][var]);
+      }
+    }
+  }
+
+  // Active variables
+  for (const auto & var : activeVars_) {
+    std::vector<atlas::array::ArrayView<double, 2>> inViews;
+    std::vector<atlas::array::ArrayView<double, 2>> outViews;
+    for (size_t jb = 0; jb < nb; ++jb) {
+      if (fsets[jb][var.name()].shape(1) != nlevs_) {
+        oops::Log::error() << "Error    : Field " << var << " has "
+                           << fsets[jb][var.name()].shape(1) << ", expected " << nlevs_ << ". "
+                           << std::endl;
+        throw eckit::UserError("Wrong number of vertical levels in field " + var.name(),
+                               Here());
+      }
+
+      // Create new field with nmods_ levels
+      atlas::Field outField =
+        innerGeometryData_.functionSpace().createField<double>
+          (atlas::option::name(var.name()) |
+           atlas::option::levels(nmods_));
+      outViews.push_back(atlas::array::make_view<double, 2>(outField));
+      outViews.back().assign(0.0);
+      inViews.push_back(atlas::array::make_view<double, 2>(fsets[jb][var.name()]));
+      fsetsOut[jb].add(outField);
+    }
+    if (nb == 0) continue;
+
+    // Apply U^t, each element being read once for all the batch members
+    atlas_omp_parallel_for(atlas::idx_t jn = 0; jn < outViews[0].shape(0); ++jn) {
+      for (atlas::idx_t jl = 0; jl < nmods_; ++jl) {
+        for (atlas::idx_t jm = 0; jm < nlevs_; ++jm) {
+          const double u = Umatrix_(jm, jl);
+          for (size_t jb = 0; jb < nb; ++jb) {
+            outViews[jb](jn, jl) += u * inViews[jb](jn, jm);
+          }
+        }
+      }
+    }
+  }
+
+  for (size_t jb = 0; jb < nb; ++jb) {
+    fsets[jb].fieldSet() = fsetsOut[jb];
+  }
+
+  oops::Log::trace() << classname() << "::multiplyADBatch done" << std::endl;
+}
+
+// -----------------------------------------------------------------------------
+
 void VertLoc::leftInverseMultiply(oops::FieldSet3D & fset) const {
   throw eckit::NotImplemented("leftInverseMultiply not implemented", Here());
 }
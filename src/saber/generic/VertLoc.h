@@ -80,6 +80,8 @@ class VertLoc : public SaberOuterBlockBase {
 
   void multiply(oops::FieldSet3D &) const override;
   void multiplyAD(oops::FieldSet3D &) const override;
+  void multiplyBatch(std::vector<oops::FieldSet3D> &) const override;
+  void multiplyADBatch(std::vector<oops::FieldSet3D> &) const override;
   void leftInverseMultiply(oops::FieldSet3D &) const override;
 
  private:
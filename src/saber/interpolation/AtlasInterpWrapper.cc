@@ -19,6 +19,8 @@
 
 #include "eckit/exception/Exceptions.h"
 
+#include "oops/util/Timer.h"
+
 // -----------------------------------------------------------------------------
 
 namespace saber {
@@ -31,7 +33,8 @@ AtlasInterpWrapper::AtlasInterpWrapper(const atlas::grid::Partitioner & srcParti
                                        const atlas::Grid & dstGrid,
                                        const atlas::FunctionSpace & dstFspace,
                                        const std::string & interpType)
-  : targetFspace_(), interp_(), redistr_(), inverseRedistr_() {
+  : targetFspace_(), interp_(), redistr_(), inverseRedistr_(), fieldAllocations_(0),
+    fieldReuses_(0) {
   oops::Log::trace() << classname() << "::AtlasInterpWrapper starting" << std::endl;
 
   // Get or compute source mesh
@@ -103,76 +106,29 @@ AtlasInterpWrapper::AtlasInterpWrapper(const atlas::grid::Partitioner & srcParti
 
 // -----------------------------------------------------------------------------
 
-void AtlasInterpWrapper::execute(const atlas::Field & srcField,
-                                 atlas::Field & dstField) const {
-  oops::Log::trace() << classname() << "::execute starting" << std::endl;
-
-  // Empty source field setup
-  atlas::Field srcTmpField = srcField.functionspace().createField(srcField);
-
-  // Copy of source field (this includes halo points; these were updated before calling execute)
-  const auto srcView = atlas::array::make_view<double, 2>(srcField);
-  auto srcTmpView = atlas::array::make_view<double, 2>(srcTmpField);
-  for (atlas::idx_t t = 0; t < srcField.shape(0); ++t) {
-    for (atlas::idx_t k = 0; k < srcField.shape(1); ++k) {
-      srcTmpView(t, k) = srcView(t, k);
-    }
-  }
-
-  // Empty target field setup
-  auto targetField = targetFspace_.createField<double>(
-    atlas::option::name(dstField.name()) | atlas::option::levels(srcField.shape(1)));
-
-  // Target field initialization
-  auto targetView = atlas::array::make_view<double, 2>(targetField);
-  targetView.assign(0.0);
-
-  // Interpolation from source field to target field
-  interp_.execute(srcTmpField, targetField);
-
-  // Redistribution from target field to destination field
-  redistr_.execute(targetField, dstField);
-
-  oops::Log::trace() << classname() << "::execute done" << std::endl;
+AtlasInterpWrapper::~AtlasInterpWrapper() {
+  oops::Log::info() << "Info     : " << classname() << ": " << fieldAllocations_
+                    << " intermediate fields allocated, " << fieldReuses_ << " reused"
+                    << std::endl;
 }
 
 // -----------------------------------------------------------------------------
 
-void AtlasInterpWrapper::executeAdjoint(atlas::Field & srcField,
-                                        const atlas::Field & dstField) const {
-  oops::Log::trace() << classname() << "::executeAdjoint starting" << std::endl;
-
-  // Empty destination field setup
-  atlas::Field dstTmp = dstField.functionspace().createField(dstField);
-
-  // Copy of destination field
-  const auto dstView = atlas::array::make_view<double, 2>(dstField);
-  auto dstTmpView = atlas::array::make_view<double, 2>(dstTmp);
-  for (atlas::idx_t t = 0; t < dstField.shape(0); ++t) {
-    for (atlas::idx_t k = 0; k < dstField.shape(1); ++k) {
-      dstTmpView(t, k) = dstView(t, k);
-    }
+atlas::Field AtlasInterpWrapper::cachedField(std::map<std::string, atlas::Field> & cache,
+                                             const atlas::FunctionSpace & fspace,
+                                             const std::string & name,
+                                             const atlas::idx_t levels) const {
+  auto it = cache.find(name);
+  if ((it != cache.end()) && (it->second.functionspace().get() == fspace.get())
+    && (it->second.shape(1) == levels)) {
+    ++fieldReuses_;
+    return it->second;
   }
-
-  // Empty target field setup
-  auto targetField = targetFspace_.createField<double>(
-  atlas::option::name(dstField.name()) | atlas::option::levels(dstField.shape(1)));
-
-  // Target field initialization
-  auto targetView = atlas::array::make_view<double, 2>(targetField);
-  targetView.assign(0.0);
-
-  // Redistribution from destination field to target field
-  inverseRedistr_.execute(dstTmp, targetField);
-
-  // Source field initialization
-  auto srcView = atlas::array::make_view<double, 2>(srcField);
-  srcView.assign(0.0);
-
-  // Adjoint interpolation target field to source field
-  interp_.execute_adjoint(srcField, targetField);
-
-  oops::Log::trace() << classname() << "::executeAdjoint done" << std::endl;
+  atlas::Field field = fspace.createField<double>(atlas::option::name(name)
+    | atlas::option::levels(levels));
+  cache[name] = field;
+  ++fieldAllocations_;
+  return field;
 }
 
 // -----------------------------------------------------------------------------
@@ -180,12 +136,43 @@ void AtlasInterpWrapper::executeAdjoint(atlas::Field & srcField,
 void AtlasInterpWrapper::execute(const atlas::FieldSet & srcFieldSet,
                                  atlas::FieldSet & targetFieldSet) const {
   oops::Log::trace() << classname() << "::execute starting" << std::endl;
+  util::Timer timer(classname(), "execute");
 
   srcFieldSet.haloExchange();
-  for (auto & srcField : srcFieldSet) {
-    execute(srcField, targetFieldSet[srcField.name()]);
+
+  atlas::FieldSet srcTmpFieldSet;
+  atlas::FieldSet targetTmpFieldSet;
+  atlas::FieldSet dstFieldSet;
+  for (const auto & srcField : srcFieldSet) {
+    // Copy of source field (this includes halo points; these were updated above)
+    atlas::Field srcTmpField = cachedField(srcTmpFields_, srcField.functionspace(),
+      srcField.name(), srcField.shape(1));
+    const auto srcView = atlas::array::make_view<double, 2>(srcField);
+    auto srcTmpView = atlas::array::make_view<double, 2>(srcTmpField);
+    for (atlas::idx_t t = 0; t < srcField.shape(0); ++t) {
+      for (atlas::idx_t k = 0; k < srcField.shape(1); ++k) {
+        srcTmpView(t, k) = srcView(t, k);
+      }
+    }
+    srcTmpField.set_dirty();  // same halo state as a freshly created field
+    srcTmpFieldSet.add(srcTmpField);
+
+    // Target field initialization
+    atlas::Field targetField = cachedField(targetFields_, targetFspace_, srcField.name(),
+      srcField.shape(1));
+    auto targetView = atlas::array::make_view<double, 2>(targetField);
+    targetView.assign(0.0);
+    targetTmpFieldSet.add(targetField);
+
+    dstFieldSet.add(targetFieldSet[srcField.name()]);
   }
 
+  // Interpolation from source fields to target fields
+  interp_.execute(srcTmpFieldSet, targetTmpFieldSet);
+
+  // Redistribution from target fields to destination fields
+  redistr_.execute(targetTmpFieldSet, dstFieldSet);
+
   oops::Log::trace() << classname() << "::execute done" << std::endl;
 }
 
@@ -194,10 +181,43 @@ void AtlasInterpWrapper::execute(const atlas::FieldSet & srcFieldSet,
 void AtlasInterpWrapper::executeAdjoint(atlas::FieldSet & srcFieldSet,
                                         const atlas::FieldSet & targetFieldSet) const {
   oops::Log::trace() << classname() << "::executeAdjoint starting" << std::endl;
+  util::Timer timer(classname(), "executeAdjoint");
 
+  atlas::FieldSet dstTmpFieldSet;
+  atlas::FieldSet targetTmpFieldSet;
   for (auto & srcField : srcFieldSet) {
-    executeAdjoint(srcField, targetFieldSet[srcField.name()]);
+    // Copy of destination field
+    const atlas::Field & dstField = targetFieldSet[srcField.name()];
+    atlas::Field dstTmpField = cachedField(dstTmpFields_, dstField.functionspace(),
+      dstField.name(), dstField.shape(1));
+    const auto dstView = atlas::array::make_view<double, 2>(dstField);
+    auto dstTmpView = atlas::array::make_view<double, 2>(dstTmpField);
+    for (atlas::idx_t t = 0; t < dstField.shape(0); ++t) {
+      for (atlas::idx_t k = 0; k < dstField.shape(1); ++k) {
+        dstTmpView(t, k) = dstView(t, k);
+      }
+    }
+    dstTmpField.set_dirty();  // same halo state as a freshly created field
+    dstTmpFieldSet.add(dstTmpField);
+
+    // Target field initialization
+    atlas::Field targetField = cachedField(targetFields_, targetFspace_, dstField.name(),
+      dstField.shape(1));
+    auto targetView = atlas::array::make_view<double, 2>(targetField);
+    targetView.assign(0.0);
+    targetTmpFieldSet.add(targetField);
+
+    // Source field initialization
+    auto srcView = atlas::array::make_view<double, 2>(srcField);
+    srcView.assign(0.0);
   }
+
+  // Redistribution from destination fields to target fields
+  inverseRedistr_.execute(dstTmpFieldSet, targetTmpFieldSet);
+
+  // Adjoint interpolation from target fields to source fields
+  interp_.execute_adjoint(srcFieldSet, targetTmpFieldSet);
+
   srcFieldSet.adjointHaloExchange();
   srcFieldSet.set_dirty();
 
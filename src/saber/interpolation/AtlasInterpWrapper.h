@@ -48,7 +48,7 @@ class AtlasInterpWrapper {
                      const atlas::Grid &,
                      const atlas::FunctionSpace &,
                      const std::string & interpType = "");
-  ~AtlasInterpWrapper() {}
+  ~AtlasInterpWrapper();
 
   void execute(const atlas::FieldSet &,
                atlas::FieldSet &) const;
@@ -67,16 +67,27 @@ class AtlasInterpWrapper {
     return redistr_;
   }
 
+  // Number of intermediate fields allocated and reused
+  size_t fieldAllocations() const {return fieldAllocations_;}
+  size_t fieldReuses() const {return fieldReuses_;}
+
  private:
-  void execute(const atlas::Field &,
-               atlas::Field &) const;
-  void executeAdjoint(atlas::Field &,
-                      const atlas::Field &) const;
+  atlas::Field cachedField(std::map<std::string, atlas::Field> &,
+                           const atlas::FunctionSpace &,
+                           const std::string &,
+                           const atlas::idx_t) const;
 
   atlas::FunctionSpace targetFspace_;
   atlas::Interpolation interp_;
   atlas::Redistribution redistr_;
   atlas::Redistribution inverseRedistr_;
+
+  // Intermediate fields, allocated on first use and reused across calls (not thread-safe)
+  mutable std::map<std::string, atlas::Field> srcTmpFields_;
+  mutable std::map<std::string, atlas::Field> targetFields_;
+  mutable std::map<std::string, atlas::Field> dstTmpFields_;
+  mutable size_t fieldAllocations_;
+  mutable size_t fieldReuses_;
 };
 
 }  // namespace interpolation
@@ -7,7 +7,9 @@
 
 #include <netcdf.h>
 
+#include <algorithm>
 #include <cmath>
+#include <numeric>
 #include <sstream>
 #include <string>
 #include <tuple>
@@ -29,6 +31,7 @@
 #include "oops/base/Variables.h"
 #include "oops/util/AtlasArrayUtil.h"
 #include "oops/util/FieldSetHelpers.h"
+#include "oops/util/Timer.h"
 
 #include "saber/interpolation/AtlasInterpWrapper.h"
 #include "saber/interpolation/Rescaling.h"
@@ -144,38 +147,58 @@ auto readCovarianceProfiles(const std::string & filePath,
 }
 
 // -----------------------------------------------------------------------------
-// lookUp function to interpolate covariance value at a given distance.
+// Position of a distance in a table of distances, so that covariances can be interpolated
+// at this distance for every level without searching the table again.
+//
+// - pos: index of the first table distance greater than or equal to the input distance, or
+//        0 if the input distance is the first table distance.
+// - a: weight of the table entry pos-1 in the linear interpolation.
+struct DistanceLookUp {
+  size_t pos;
+  double a;
+};
+
+// -----------------------------------------------------------------------------
+// Locate distance x in xx.
 //
 // Input parameters:
 // - xx: 1D input distance vector, sorted by increasing order.
-// - yView: 2D array view so that yy := yView(:, lev) is the output vector of
-//          covariances associated to xx.
-//          xx and yy define a piecewise linear function f so that f(xx) == yy.
-// - lev: vertical level to define yy from yView.
 // - x: input distance, with xx[0] <= x <= xx[xx.size()-1].
-//
-// Returns:
-//  The interpolated covariance value y == f(x).
-double lookUpCovarianceAtDistance(const std::vector<double> & xx,
-                                  const atlas::array::ArrayView<const double, 2> & yView,
-                                  const size_t lev,
-                                  const double x) {
-  if (x == xx[0]) return yView(0, lev);
+DistanceLookUp locateDistance(const std::vector<double> & xx,
+                              const double x) {
+  if (x == xx[0]) return DistanceLookUp{0, 0.0};
 
   // Find position of x in xx
   const auto ind = std::lower_bound(xx.cbegin(), xx.cend(), x);
-  if (ind == xx.cend()) {
+  if (ind == xx.cend() || ind == xx.cbegin()) {
     std::stringstream errorMsg;
-    errorMsg << "Received distance " << x << "m, but maximum input distance"
-             << " in profile is " << xx[xx.size()-1];
+    errorMsg << "Received distance " << x << "m, but input distances"
+             << " in profile range from " << xx[0] << " to " << xx[xx.size()-1];
     throw eckit::UserError(errorMsg.str(), Here());
   }
-  const auto pos = std::distance(xx.cbegin(), ind);
+  const size_t pos = std::distance(xx.cbegin(), ind);
+  return DistanceLookUp{pos, (xx[pos] - x) / (xx[pos] - xx[pos-1])};
+}
+
+// -----------------------------------------------------------------------------
+// lookUp function to interpolate covariance value at a located distance.
+//
+// Input parameters:
+// - lookUp: position of the distance in the distance vector xx.
+// - yView: 2D array view so that yy := yView(:, lev) is the output vector of
+//          covariances associated to xx.
+//          xx and yy define a piecewise linear function f so that f(xx) == yy.
+// - lev: vertical level to define yy from yView.
+//
+// Returns:
+//  The interpolated covariance value y == f(x).
+inline double lookUpCovarianceAtDistance(const DistanceLookUp & lookUp,
+                                         const atlas::array::ArrayView<const double, 2> & yView,
+                                         const size_t lev) {
+  if (lookUp.pos == 0) return yView(0, lev);
 
   // Perform linear interpolation
-  const double a = (xx[pos] - x) / (xx[pos] - xx[pos-1]);
-  const double y = a * yView(pos-1, lev) + (1-a) * yView(pos, lev);
-  return y;
+  return lookUp.a * yView(lookUp.pos-1, lev) + (1-lookUp.a) * yView(lookUp.pos, lev);
 }
 
 // -----------------------------------------------------------------------------
@@ -189,6 +212,7 @@ computeRescalingCoeffs(
         const atlas::FieldSet & covariances,
         const std::vector<double> & alphas) {
   oops::Log::trace() << "computeRescalingCoeffs starting" << std::endl;
+  util::Timer timer("saber::interpolation::Rescaling", "computeRescalingCoeffs");
 
   const auto & interpMatrix = interp.getInterpolationMatrix();
   // matData is the array of all non-zero matrix coefficients
@@ -199,12 +223,67 @@ computeRescalingCoeffs(
   const auto & matOuter = interpMatrix.outer();
 
   const auto & matchingOuterFspace = interp.getIntermediateFunctionSpace();
+  const atlas::idx_t nNodes = matchingOuterFspace.createField<double>(
+                atlas::option::levels(1) |
+                atlas::option::halo(0)).shape(0);
+  ASSERT(static_cast<size_t>(nNodes) <= interpMatrix.rows());
+
+  // Extract matrices of distances D, typically of size 4 by 4, once for all variables.
+  // D_ij is distance between points i and j on inner grid, for the points of the jnode-th
+  // compressed row of the interpolation matrix. D is stored row by row from offsets[jnode]
+  // in a contiguous buffer.
+  std::vector<size_t> offsets(nNodes+1, 0);
+  for (atlas::idx_t jnode = 0; jnode < nNodes; jnode++) {
+    const size_t points = matOuter[jnode+1] - matOuter[jnode];
+    offsets[jnode+1] = offsets[jnode] + points*points;
+  }
+  std::vector<double> distances(offsets[nNodes]);
+  const auto lonlatView = atlas::array::make_view<double, 2>(innerFspace.lonlat());
+  # pragma omp parallel for
+  for (atlas::idx_t jnode = 0; jnode < nNodes; jnode++) {
+    const size_t points = matOuter[jnode+1] - matOuter[jnode];
+    const auto colIndex = matInner + matOuter[jnode];
+    double * dist = distances.data() + offsets[jnode];
+    for (size_t i = 0; i < points; i++) {
+      const auto point1 = atlas::Point2(lonlatView(colIndex[i], atlas::LON),
+                                        lonlatView(colIndex[i], atlas::LAT));
+      dist[i*points+i] = 0.0;
+      for (size_t j = i+1; j < points; j++) {
+        // Use symmetry to fill the distance matrix
+        const auto point2 = atlas::Point2(lonlatView(colIndex[j], atlas::LON),
+                                          lonlatView(colIndex[j], atlas::LAT));
+        dist[i*points+j] = atlas::util::Earth().distance(point1, point2);
+        dist[j*points+i] = dist[i*points+j];
+      }
+    }
+  }
+
+  // Locate all distances in the binned distances of each variable. Variables with the same
+  // binned distances share the same look-up.
+  std::vector<std::vector<DistanceLookUp>> lookUps;
+  std::vector<const std::vector<double> *> lookUpDistances;
+  std::vector<size_t> lookUpIndex;
+  for (const auto & var : activeVars) {
+    const auto & binnedDistance = binnedDistances.at(var.name());
+    size_t index = 0;
+    while (index < lookUps.size() && *lookUpDistances[index] != binnedDistance) ++index;
+    if (index == lookUps.size()) {
+      std::vector<DistanceLookUp> lookUp;
+      lookUp.reserve(distances.size());
+      for (const auto & dist : distances) {
+        lookUp.push_back(locateDistance(binnedDistance, dist));
+      }
+      lookUps.push_back(std::move(lookUp));
+      lookUpDistances.push_back(&binnedDistance);
+    }
+    lookUpIndex.push_back(index);
+  }
 
   atlas::FieldSet multFset;
   atlas::FieldSet addFset;
   int ivar = 0;
   for (const auto & var : activeVars) {
-    const auto binnedDistance = binnedDistances.at(var.name());
+    const auto & lookUp = lookUps[lookUpIndex[ivar]];
     const auto covView = atlas::array::make_view<double, 2>(covariances[var.name()]);
 
     const size_t levels = var.getLevels();
@@ -221,90 +300,48 @@ computeRescalingCoeffs(
                 atlas::option::halo(0));
     auto actualVarView = atlas::array::make_view<double, 2>(actualVarField);
 
-    const auto lonlatView = atlas::array::make_view<double, 2>(innerFspace.lonlat());
-
-    int matIndex = 0;
-    for (atlas::idx_t jnode = 0; jnode < targetVarView.shape(0); jnode++) {
-      // Extract jnode-th compressed row of the interpolationMatrix
-      const size_t points = matOuter[jnode+1] - matOuter[jnode];
-      std::vector<double> weights;
-      std::vector<size_t> colIndex;
-      weights.reserve(points);
-      colIndex.reserve(points);
-      while (matIndex < matOuter[jnode+1]) {
-        weights.push_back(matData[matIndex]);
-        colIndex.push_back(matInner[matIndex]);
-        matIndex++;
-      }
-
-      // Extract matrix of distances D, typically of size 4 by 4.
-      // D_ij is distance between points i and j on inner grid.
-      std::vector<std::vector<double>> distances;
-      for (size_t i = 0; i < points; i++) {
-        const auto jnode1 = colIndex[i];
-        const auto point1 = atlas::Point2(lonlatView(jnode1, atlas::LON),
-                                          lonlatView(jnode1, atlas::LAT));
-        std::vector<double> row;
-        row.reserve(points);
-        for (size_t j = 0; j < points; j++) {
-          // Use symmetry to fill the distance matrix
-          if (j < i) {
-            // Lower part
-            row.push_back(distances[j][i]);
-          } else if (j == i) {
-            // Diagonal
-            row.push_back(0.0);
-          } else {
-            // Upper part
-            const auto jnode2 = colIndex[j];
-            const auto point2 = atlas::Point2(lonlatView(jnode2, atlas::LON),
-                                              lonlatView(jnode2, atlas::LAT));
-            const double dist = atlas::util::Earth().distance(point1, point2);
-            row.push_back(dist);
+    # pragma omp parallel
+    {
+      // Thread-local covariance matrix C, variances and product C w
+      std::vector<double> covs;
+      std::vector<double> variances;
+      std::vector<double> Cw;
+
+      # pragma omp for
+      for (atlas::idx_t jnode = 0; jnode < nNodes; jnode++) {
+        // Interpolation weights w of the jnode-th compressed row of the interpolation matrix
+        const size_t points = matOuter[jnode+1] - matOuter[jnode];
+        const auto weights = matData + matOuter[jnode];
+        const DistanceLookUp * nodeLookUp = lookUp.data() + offsets[jnode];
+        covs.resize(points*points);
+        variances.resize(points);
+        Cw.resize(points);
+
+        for (size_t lev = 0; lev < levels; lev++) {
+          // Extract covariance matrix C associated to distance matrix
+          for (size_t ij = 0; ij < points*points; ij++) {
+            covs[ij] = lookUpCovarianceAtDistance(nodeLookUp[ij], covView, lev);
           }
-        }
-        distances.push_back(row);
-      }
-
-      for (size_t lev = 0; lev < levels; lev++) {
-        // Extract covariance matrix C associated to distance matrix
-        std::vector<std::vector<double>> covs;
-        std::vector<double> variances;
-        variances.reserve(points);
-        for (size_t i = 0; i < points; i++) {
-          std::vector<double> row;
-          row.reserve(points);
-          for (size_t j = 0; j < points; j++) {
-            if (j < i) {
-              // Lower part
-              row.push_back(covs[j][i]);
-            } else {
-              // Diagonal and upper part
-              const double dist = distances[i][j];
-              const double cov = lookUpCovarianceAtDistance(binnedDistance, covView, lev, dist);
-              row.push_back(cov);
-            }
+          for (size_t i = 0; i < points; i++) {
+            variances[i] = covs[i*points+i];
           }
-          covs.push_back(row);
-          variances.push_back(row[i]);
-        }
 
-        // Compute target interpolated variance: v^T w
-        // Where v is the vector of variances and w the interpolation weights
-        const double targetInterpolatedVariance = std::inner_product(
-                    weights.cbegin(), weights.cend(), variances.cbegin(), 0.0);
-        targetVarView(jnode, lev) = targetInterpolatedVariance;
-
-        // Compute variance of interpolated value: w^T C w
-        // where C is the covariance matrix and w the interpolation weights
-        std::vector<double> Cw;
-        for (const auto & row : covs) {
-          Cw.push_back(std::inner_product(
-                    row.cbegin(), row.cend(), weights.cbegin(), 0.0));
+          // Compute target interpolated variance: v^T w
+          // Where v is the vector of variances and w the interpolation weights
+          const double targetInterpolatedVariance = std::inner_product(
+                      weights, weights + points, variances.cbegin(), 0.0);
+          targetVarView(jnode, lev) = targetInterpolatedVariance;
+
+          // Compute variance of interpolated value: w^T C w
+          // where C is the covariance matrix and w the interpolation weights
+          for (size_t i = 0; i < points; i++) {
+            Cw[i] = std::inner_product(covs.cbegin() + i*points, covs.cbegin() + (i+1)*points,
+                                       weights, 0.0);
+          }
+          const double varianceOfInterpolatedValue = std::inner_product(
+                      weights, weights + points, Cw.cbegin(), 0.0);
+          actualVarView(jnode, lev) = varianceOfInterpolatedValue;
         }
-        const double varianceOfInterpolatedValue = std::inner_product(
-                    weights.cbegin(), weights.cend(), Cw.cbegin(), 0.0);
-        actualVarView(jnode, lev) = varianceOfInterpolatedValue;
       }
     }
 
@@ -128,14 +128,10 @@ void VertProj::multiply(oops::FieldSet3D & fieldSet) const {
   atlas::FieldSet modelFieldSet;
   // Note: ambiguity in levels in active variables; get levels from outer vars
   for (const auto & var : activeVars_) {
-    atlas::Field modelField =
-      outerGeometryData_.functionSpace().createField<double>(
-          atlas::option::name(var.name()) |
-          atlas::option::levels(outerVars_[var.name()].getLevels()) |
-          atlas::option::halo(1));
-    atlas::array::make_view<double, 2>(modelField).assign(0.0);
-    modelField.set_dirty(false);
-    modelFieldSet.add(modelField);
+    modelFieldSet.add(pooledField(outerGeometryData_.functionSpace(),
+                                  atlas::option::name(var.name()) |
+                                  atlas::option::levels(outerVars_[var.name()].getLevels()) |
+                                  atlas::option::halo(1)));
   }
 
   // Simple prologation scheme
@@ -176,14 +172,10 @@ void VertProj::multiplyAD(oops::FieldSet3D & fieldSet) const {
   atlas::FieldSet vertFieldSet;
   // Note: ambiguity in levels in active variables; get levels from inner vars
   for (const auto & var : activeVars_) {
-    atlas::Field vertField =
-      outerGeometryData_.functionSpace().createField<double>
-        (atlas::option::name(var.name()) |
-         atlas::option::levels(innerVars_[var.name()].getLevels()) |
-         atlas::option::halo(1));
-    atlas::array::make_view<double, 2>(vertField).assign(0.0);
-    vertField.set_dirty(false);
-    vertFieldSet.add(vertField);
+    vertFieldSet.add(pooledField(outerGeometryData_.functionSpace(),
+                                 atlas::option::name(var.name()) |
+                                 atlas::option::levels(innerVars_[var.name()].getLevels()) |
+                                 atlas::option::halo(1)));
   }
 
   // Adjoint of simple prolongation scheme
@@ -8,12 +8,16 @@
 
 #pragma once
 
+#include <algorithm>
+#include <cmath>
+#include <iterator>
 #include <memory>
 #include <string>
 #include <vector>
 
 #include "atlas/field.h"
 
+#include "eckit/log/Timer.h"
 #include "eckit/mpi/Comm.h"
 
 #include "oops/base/Geometry.h"
@@ -53,6 +57,46 @@ inline std::string parametricIfNotEnsemble(const std::string & blockName) {
 
 // -----------------------------------------------------------------------------
 
+/// Number of MPI tasks of each parallel hybrid component, proportional to its work (time
+/// multiplied by the current number of tasks), with at least one task per component and the
+/// same total number of tasks
+inline std::vector<size_t> balanceComponentTasks(const std::vector<size_t> & tasks,
+                                                 const std::vector<double> & times) {
+  const size_t nComponents = tasks.size();
+  size_t ntasks = 0;
+  double totalWork = 0.0;
+  for (size_t jc = 0; jc < nComponents; ++jc) {
+    ntasks += tasks[jc];
+    totalWork += times[jc]*static_cast<double>(tasks[jc]);
+  }
+  if (totalWork <= 0.0) return tasks;
+
+  std::vector<size_t> balancedTasks(nComponents);
+  size_t nBalanced = 0;
+  for (size_t jc = 0; jc < nComponents; ++jc) {
+    const double share = times[jc]*static_cast<double>(tasks[jc]*ntasks)/totalWork;
+    balancedTasks[jc] = std::max(static_cast<size_t>(1), static_cast<size_t>(std::round(share)));
+    nBalanced += balancedTasks[jc];
+  }
+
+  // Fix the total on the largest components
+  while (nBalanced != ntasks) {
+    const size_t jc = std::distance(balancedTasks.begin(),
+      std::max_element(balancedTasks.begin(), balancedTasks.end()));
+    if (nBalanced > ntasks) {
+      ASSERT(balancedTasks[jc] > 1);
+      --balancedTasks[jc];
+      --nBalanced;
+    } else {
+      ++balancedTasks[jc];
+      ++nBalanced;
+    }
+  }
+  return balancedTasks;
+}
+
+// -----------------------------------------------------------------------------
+
 template <typename MODEL>
 class ErrorCovariance : public oops::ModelSpaceCovarianceBase<MODEL>,
                         public util::Printable,
@@ -82,6 +126,13 @@ class ErrorCovariance : public oops::ModelSpaceCovarianceBase<MODEL>,
 
   void print(std::ostream &) const override;
 
+  void setupParallelHybrid(const Geometry_ &, const State4D_ &, const State4D_ &,
+                           const ErrorCovarianceParameters<MODEL> &,
+                           const eckit::LocalConfiguration &, const oops::Variables &,
+                           const Geometry_ &, oops::FieldSets &, const std::vector<size_t> &);
+  std::vector<double> timeParallelHybridComponents(const eckit::mpi::Comm &,
+                                                   const State4D_ &) const;
+
   /// Chain of outer blocks applied to all components of hybrid covariances.
   /// Not initialized for non-hybrid covariances.
   std::unique_ptr<SaberOuterBlockChain> outerBlockChain_;
@@ -100,6 +151,14 @@ class ErrorCovariance : public oops::ModelSpaceCovarianceBase<MODEL>,
   size_t myComponent_;  // This is not strictly necessary
   /// local geometry just out of parallel Hybrid block
   std::shared_ptr<Geometry_> localHybridGeom_;
+  /// Number of MPI tasks of each component if running Hybrid in parallel
+  std::vector<size_t> hybridComponentTasks_;
+  /// Cumulated multiplication time of each component (on this task until the destructor
+  /// reduces them) and number of multiplications, if running Hybrid in parallel
+  mutable std::vector<double> hybridComponentTimes_;
+  mutable size_t hybridApplications_;
+  /// Name of the global communicator, to reduce the component timings
+  std::string globalSpaceCommName_;
 };
 
 // -----------------------------------------------------------------------------
@@ -112,7 +171,8 @@ ErrorCovariance<MODEL>::ErrorCovariance(const Geometry_ & geom,
                                         const State4D_ & fg)
   : oops::ModelSpaceCovarianceBase<MODEL>(geom, config, xb, fg),
     parallelHybrid_(false),
-    myComponent_(-1)
+    myComponent_(-1),
+    hybridApplications_(0)
 {
   oops::Log::trace() << "ErrorCovariance::ErrorCovariance starting" << std::endl;
   ErrorCovarianceParameters<MODEL> params;
@@ -153,7 +213,12 @@ ErrorCovariance<MODEL>::ErrorCovariance(const Geometry_ & geom,
   covarConf.set("square-root test", params.sqrtTest.value());
   covarConf.set("square-root tolerance", params.sqrtTolerance.value());
   covarConf.set("iterative ensemble loading", params.iterativeEnsembleLoading.value());
+  covarConf.set("iterative ensemble loading prefetch depth",
+                params.iterativeEnsembleLoadingPrefetchDepth.value());
+  covarConf.set("iterative ensemble loading prefetch memory",
+                params.iterativeEnsembleLoadingPrefetchMemory.value());
   covarConf.set("time covariance", params.timeCovariance.value());
+  covarConf.set("time covariance reduction", params.timeCovarianceReduction.value());
 
   // Iterative ensemble loading flag
   const bool iterativeEnsembleLoading = params.iterativeEnsembleLoading.value();
@@ -234,6 +299,7 @@ ErrorCovariance<MODEL>::ErrorCovariance(const Geometry_ & geom,
     const size_t nComponents = hybridConf.getSubConfigurations("components").size();
     const eckit::mpi::Comm & globalSpaceComm = geom.getComm();
     const size_t ntasks = globalSpaceComm.size();
+    globalSpaceCommName_ = globalSpaceComm.name();
 
     if (parallelHybrid_ && ntasks % nComponents != 0) {
       oops::Log::warning() << "Warning  : Number of MPI tasks not divisible "
@@ -251,136 +317,53 @@ ErrorCovariance<MODEL>::ErrorCovariance(const Geometry_ & geom,
                                     Here());
       }
 
-      const eckit::mpi::Comm & initialDefaultComm = eckit::mpi::comm();
-      ASSERT(initialDefaultComm.name() == globalSpaceComm.name());
-
-      // We split the space communicators only, the time parallelization is untouched
-      const size_t myTask = globalSpaceComm.rank();
-      const size_t tasksPerComponent = ntasks / nComponents;
-      myComponent_ = myTask / tasksPerComponent;
-
-      oops::Log::info() << "Info     : Creating component " << myComponent_ + 1
-                        << "/" << nComponents
-                        << " of Hybrid block using " << tasksPerComponent
-                        << " MPI tasks." << std::endl;
-
-      // Create communicators for same component, for communications in space
-      const auto spaceCommName = ("comm_space_" + std::to_string(myComponent_));
-      if (eckit::mpi::hasComm(spaceCommName.c_str())) {
-        eckit::mpi::deleteComm(spaceCommName.c_str());
+      const std::string parallelSizing = hybridConf.getString("parallel sizing", "equal");
+      if (parallelSizing != "equal" && parallelSizing != "prescribed"
+        && parallelSizing != "automatic") {
+        throw eckit::UserError("Wrong parallel sizing for the Hybrid block: " + parallelSizing,
+                               Here());
       }
-      const auto & localSpaceComm = globalSpaceComm.split(myComponent_, spaceCommName.c_str());
 
-      // Create block geometry (needed for ensemble reading and local geometries)
-      if (!hybridConf.has("geometry")) {
-        throw eckit::UserError("Parallel hybrid block requires geometry key", Here());
-      }
-      const auto geomConf = hybridConf.getSubConfiguration("geometry");
-      // The hybrid Geometry is stored as a class member to ensure it doesn't go
-      // out of scope after construction, as it is directly used (not copied) by
-      // the hybrid Block Chains.
-      localHybridGeom_.reset(new Geometry_(geomConf, localSpaceComm, geom.timeComm()));
-
-      // Copy and redistribute the background and first guess
-      State4D_ localXb(*localHybridGeom_, xb.variables(), xb.times(), xb.commTime());
-      State4D_ localFg(*localHybridGeom_, fg.variables(), fg.times(), fg.commTime());
-
-      for (size_t jtime = 0; jtime < xb.size(); jtime++) {
-        util::redistributeToSubcommunicator(xb[jtime].fieldSet().fieldSet(),
-                                            localXb[jtime].fieldSet().fieldSet(),
-                                            globalSpaceComm,
-                                            localSpaceComm,
-                                            geom.functionSpace(),
-                                            localHybridGeom_->functionSpace());
-        util::redistributeToSubcommunicator(fg[jtime].fieldSet().fieldSet(),
-                                            localFg[jtime].fieldSet().fieldSet(),
-                                            globalSpaceComm,
-                                            localSpaceComm,
-                                            geom.functionSpace(),
-                                            localHybridGeom_->functionSpace());
+      // Start with the same number of MPI tasks for all components
+      std::vector<size_t> componentTasks(nComponents, ntasks / nComponents);
+      if (parallelSizing == "prescribed") {
+        // Number of MPI tasks in proportion to the prescribed relative costs
+        std::vector<double> costs;
+        for (const auto & cmp : hybridConf.getSubConfigurations("components")) {
+          costs.push_back(cmp.getDouble("relative cost", 1.0));
+        }
+        componentTasks = balanceComponentTasks(componentTasks, costs);
       }
-      globalSpaceComm.barrier();
-
-      // Set up default MPI communicator for atlas
-      eckit::mpi::setCommDefault(localSpaceComm.name().c_str());
-
-      const oops::FieldSet4D localFset4dXbTmp(localXb);
-      const oops::FieldSet4D localFset4dFgTmp(localFg);
-
-      oops::FieldSet4D localFset4dXb = oops::copyFieldSet4D(localFset4dXbTmp);
-      oops::FieldSet4D localFset4dFg = oops::copyFieldSet4D(localFset4dFgTmp);
-
-      const auto cmp = hybridConf.getSubConfigurations("components")[myComponent_];
-
-      // Initialize component outer variables
-      const oops::Variables cmpOuterVars(outerVars);
-
-      // Set weight
-      eckit::LocalConfiguration weightConf = cmp.getSubConfiguration("weight");
-      // Scalar weight
-      hybridScalarWeightSqrt_.push_back(std::sqrt(weightConf.getDouble("value", 1.0)));
-
-      // File-base weight
-      oops::FieldSet3D fsetWeight(localXb[0].validTime(), localSpaceComm);
-      if (weightConf.has("file")) {
-        // File-base weight
-        readHybridWeight(*localHybridGeom_,
-                         outerVars,
-                         localXb[0].validTime(),
-                         weightConf.getSubConfiguration("file"),
-                         fsetWeight);
-        fsetWeight.sqrt();
+      setupParallelHybrid(geom, xb, fg, params, hybridConf, outerVars, *dualResGeom,
+                          *fsetDualResEns, componentTasks);
+
+      if (parallelSizing == "automatic") {
+        // Warm-up application to measure the cost of each component
+        const std::vector<double> times = timeParallelHybridComponents(globalSpaceComm,
+                                                                       xb);
+
+        // Rebuild the components only if the imbalance is large enough to pay for it: the
+        // warm-up time of cheap components is mostly noise
+        const double maxTime = *std::max_element(times.begin(), times.end());
+        const double minTime = *std::min_element(times.begin(), times.end());
+        const double imbalance = maxTime > 0.0 ? (maxTime-minTime)/maxTime : 0.0;
+        const double threshold = hybridConf.getDouble("parallel sizing threshold", 0.2);
+        oops::Log::info() << "Info     : Hybrid components imbalance: " << imbalance
+                          << " (threshold: " << threshold << ")" << std::endl;
+        const std::vector<size_t> balancedTasks = imbalance > threshold
+          ? balanceComponentTasks(componentTasks, times) : componentTasks;
+        if (balancedTasks != componentTasks) {
+          oops::Log::info() << "Info     : Resizing Hybrid block components from measured "
+                            << "costs" << std::endl;
+          hybridBlockChain_.clear();
+          hybridScalarWeightSqrt_.clear();
+          hybridFieldWeightSqrt_.clear();
+          localHybridGeom_.reset();
+          eckit::mpi::deleteComm(("comm_space_" + std::to_string(myComponent_)).c_str());
+          setupParallelHybrid(geom, xb, fg, params, hybridConf, outerVars, *dualResGeom,
+                              *fsetDualResEns, balancedTasks);
+        }
       }
-      hybridFieldWeightSqrt_.push_back(fsetWeight);
-
-      // Set covariance
-      eckit::LocalConfiguration cmpConf = cmp.getSubConfiguration("covariance");
-
-      // Read ensemble
-      eckit::LocalConfiguration cmpEnsembleConf;
-      oops::FieldSets localFset4dCmpEns
-         = readEnsemble(*localHybridGeom_,
-                        cmpOuterVars,
-                        localXb,
-                        localFg,
-                        cmpConf,
-                        params.iterativeEnsembleLoading.value(),
-                        cmpEnsembleConf);
-
-      // Create internal configuration
-      eckit::LocalConfiguration cmpCovarConf;
-      cmpCovarConf.set("ensemble configuration", cmpEnsembleConf);
-      cmpCovarConf.set("adjoint test", params.adjointTest.value());
-      cmpCovarConf.set("adjoint tolerance", params.adjointTolerance.value());
-      cmpCovarConf.set("inverse test", params.inverseTest.value());
-      cmpCovarConf.set("inverse tolerance", params.inverseTolerance.value());
-      cmpCovarConf.set("square-root test", params.sqrtTest.value());
-      cmpCovarConf.set("square-root tolerance", params.sqrtTolerance.value());
-      cmpCovarConf.set("iterative ensemble loading", params.iterativeEnsembleLoading.value());
-      cmpCovarConf.set("time covariance", params.timeCovariance.value());
-
-      SaberCentralBlockParametersWrapper cmpCentralBlockParamsWrapper;
-      cmpCentralBlockParamsWrapper.deserialize(cmpConf.getSubConfiguration("saber central block"));
-      const auto & centralBlockParams =
-                   cmpCentralBlockParamsWrapper.saberCentralBlockParameters.value();
-
-      hybridBlockChain_.push_back(
-        SaberBlockChainFactory<MODEL>::create
-         (parametricIfNotEnsemble(centralBlockParams.saberBlockName.value()),
-          *localHybridGeom_,
-          *dualResGeom,
-          cmpOuterVars,
-          localFset4dXb,
-          localFset4dFg,
-          localFset4dCmpEns,
-          *fsetDualResEns,
-          cmpCovarConf,
-          cmpConf));
-
-      ASSERT(hybridBlockChain_.size() > 0);
-
-      // Restore previous default MPI communicator for atlas
-      eckit::mpi::setCommDefault(globalSpaceComm.name().c_str());
     } else {
       oops::Log::info() << "Info     : Creating Hybrid block serially" << std::endl;
       // Create block geometry (needed for ensemble reading)
@@ -434,7 +417,12 @@ ErrorCovariance<MODEL>::ErrorCovariance(const Geometry_ & geom,
         cmpCovarConf.set("square-root test", params.sqrtTest.value());
         cmpCovarConf.set("square-root tolerance", params.sqrtTolerance.value());
         cmpCovarConf.set("iterative ensemble loading", params.iterativeEnsembleLoading.value());
+        cmpCovarConf.set("iterative ensemble loading prefetch depth",
+                         params.iterativeEnsembleLoadingPrefetchDepth.value());
+        cmpCovarConf.set("iterative ensemble loading prefetch memory",
+                         params.iterativeEnsembleLoadingPrefetchMemory.value());
         cmpCovarConf.set("time covariance", params.timeCovariance.value());
+        cmpCovarConf.set("time covariance reduction", params.timeCovarianceReduction.value());
 
         SaberCentralBlockParametersWrapper cmpCentralBlockParamsWrapper;
         cmpCentralBlockParamsWrapper.deserialize(
@@ -484,10 +472,221 @@ ErrorCovariance<MODEL>::ErrorCovariance(const Geometry_ & geom,
 
 // -----------------------------------------------------------------------------
 
+template<typename MODEL>
+void ErrorCovariance<MODEL>::setupParallelHybrid(const Geometry_ & geom,
+                                                 const State4D_ & xb,
+                                                 const State4D_ & fg,
+                                                 const ErrorCovarianceParameters<MODEL> & params,
+                                                 const eckit::LocalConfiguration & hybridConf,
+                                                 const oops::Variables & outerVars,
+                                                 const Geometry_ & dualResGeom,
+                                                 oops::FieldSets & fsetDualResEns,
+                                                 const std::vector<size_t> & componentTasks) {
+  oops::Log::trace() << "ErrorCovariance::setupParallelHybrid starting" << std::endl;
+
+  const eckit::mpi::Comm & globalSpaceComm = geom.getComm();
+  const eckit::mpi::Comm & initialDefaultComm = eckit::mpi::comm();
+  ASSERT(initialDefaultComm.name() == globalSpaceComm.name());
+
+  // We split the space communicators only, the time parallelization is untouched
+  const size_t myTask = globalSpaceComm.rank();
+  const size_t nComponents = componentTasks.size();
+  size_t firstTask = 0;
+  for (myComponent_ = 0; myComponent_ < nComponents; ++myComponent_) {
+    if (myTask < firstTask+componentTasks[myComponent_]) break;
+    firstTask += componentTasks[myComponent_];
+  }
+  ASSERT(myComponent_ < nComponents);
+  hybridComponentTasks_ = componentTasks;
+  hybridComponentTimes_.assign(nComponents, 0.0);
+  hybridApplications_ = 0;
+
+  oops::Log::info() << "Info     : Creating component " << myComponent_ + 1
+                    << "/" << nComponents
+                    << " of Hybrid block using " << componentTasks[myComponent_]
+                    << " MPI tasks." << std::endl;
+
+  // Create communicators for same component, for communications in space
+  const auto spaceCommName = ("comm_space_" + std::to_string(myComponent_));
+  if (eckit::mpi::hasComm(spaceCommName.c_str())) {
+    eckit::mpi::deleteComm(spaceCommName.c_str());
+  }
+  const auto & localSpaceComm = globalSpaceComm.split(myComponent_, spaceCommName.c_str());
+
+  // Create block geometry (needed for ensemble reading and local geometries)
+  if (!hybridConf.has("geometry")) {
+    throw eckit::UserError("Parallel hybrid block requires geometry key", Here());
+  }
+  const auto geomConf = hybridConf.getSubConfiguration("geometry");
+  // The hybrid Geometry is stored as a class member to ensure it doesn't go
+  // out of scope after construction, as it is directly used (not copied) by
+  // the hybrid Block Chains.
+  localHybridGeom_.reset(new Geometry_(geomConf, localSpaceComm, geom.timeComm()));
+
+  // Copy and redistribute the background and first guess
+  State4D_ localXb(*localHybridGeom_, xb.variables(), xb.times(), xb.commTime());
+  State4D_ localFg(*localHybridGeom_, fg.variables(), fg.times(), fg.commTime());
+
+  for (size_t jtime = 0; jtime < xb.size(); jtime++) {
+    util::redistributeToSubcommunicator(xb[jtime].fieldSet().fieldSet(),
+                                        localXb[jtime].fieldSet().fieldSet(),
+                                        globalSpaceComm,
+                                        localSpaceComm,
+                                        geom.functionSpace(),
+                                        localHybridGeom_->functionSpace());
+    util::redistributeToSubcommunicator(fg[jtime].fieldSet().fieldSet(),
+                                        localFg[jtime].fieldSet().fieldSet(),
+                                        globalSpaceComm,
+                                        localSpaceComm,
+                                        geom.functionSpace(),
+                                        localHybridGeom_->functionSpace());
+  }
+  // Set up default MPI communicator for atlas
+  eckit::mpi::setCommDefault(localSpaceComm.name().c_str());
+
+  const oops::FieldSet4D localFset4dXbTmp(localXb);
+  const oops::FieldSet4D localFset4dFgTmp(localFg);
+
+  oops::FieldSet4D localFset4dXb = oops::copyFieldSet4D(localFset4dXbTmp);
+  oops::FieldSet4D localFset4dFg = oops::copyFieldSet4D(localFset4dFgTmp);
+
+  const auto cmp = hybridConf.getSubConfigurations("components")[myComponent_];
+
+  // Initialize component outer variables
+  const oops::Variables cmpOuterVars(outerVars);
+
+  // Set weight
+  eckit::LocalConfiguration weightConf = cmp.getSubConfiguration("weight");
+  // Scalar weight
+  hybridScalarWeightSqrt_.push_back(std::sqrt(weightConf.getDouble("value", 1.0)));
+
+  // File-base weight
+  oops::FieldSet3D fsetWeight(localXb[0].validTime(), localSpaceComm);
+  if (weightConf.has("file")) {
+    // File-base weight
+    readHybridWeight(*localHybridGeom_,
+                     outerVars,
+                     localXb[0].validTime(),
+                     weightConf.getSubConfiguration("file"),
+                     fsetWeight);
+    fsetWeight.sqrt();
+  }
+  hybridFieldWeightSqrt_.push_back(fsetWeight);
+
+  // Set covariance
+  eckit::LocalConfiguration cmpConf = cmp.getSubConfiguration("covariance");
+
+  // Read ensemble
+  eckit::LocalConfiguration cmpEnsembleConf;
+  oops::FieldSets localFset4dCmpEns
+     = readEnsemble(*localHybridGeom_,
+                    cmpOuterVars,
+                    localXb,
+                    localFg,
+                    cmpConf,
+                    params.iterativeEnsembleLoading.value(),
+                    cmpEnsembleConf);
+
+  // Create internal configuration
+  eckit::LocalConfiguration cmpCovarConf;
+  cmpCovarConf.set("ensemble configuration", cmpEnsembleConf);
+  cmpCovarConf.set("adjoint test", params.adjointTest.value());
+  cmpCovarConf.set("adjoint tolerance", params.adjointTolerance.value());
+  cmpCovarConf.set("inverse test", params.inverseTest.value());
+  cmpCovarConf.set("inverse tolerance", params.inverseTolerance.value());
+  cmpCovarConf.set("square-root test", params.sqrtTest.value());
+  cmpCovarConf.set("square-root tolerance", params.sqrtTolerance.value());
+  cmpCovarConf.set("iterative ensemble loading", params.iterativeEnsembleLoading.value());
+  cmpCovarConf.set("iterative ensemble loading prefetch depth",
+                   params.iterativeEnsembleLoadingPrefetchDepth.value());
+  cmpCovarConf.set("iterative ensemble loading prefetch memory",
+                   params.iterativeEnsembleLoadingPrefetchMemory.value());
+  cmpCovarConf.set("time covariance", params.timeCovariance.value());
+  cmpCovarConf.set("time covariance reduction", params.timeCovarianceReduction.value());
+
+  SaberCentralBlockParametersWrapper cmpCentralBlockParamsWrapper;
+  cmpCentralBlockParamsWrapper.deserialize(cmpConf.getSubConfiguration("saber central block"));
+  const auto & centralBlockParams =
+               cmpCentralBlockParamsWrapper.saberCentralBlockParameters.value();
+
+  hybridBlockChain_.push_back(
+    SaberBlockChainFactory<MODEL>::create
+     (parametricIfNotEnsemble(centralBlockParams.saberBlockName.value()),
+      *localHybridGeom_,
+      dualResGeom,
+      cmpOuterVars,
+      localFset4dXb,
+      localFset4dFg,
+      localFset4dCmpEns,
+      fsetDualResEns,
+      cmpCovarConf,
+      cmpConf));
+
+  ASSERT(hybridBlockChain_.size() > 0);
+
+  // Restore previous default MPI communicator for atlas
+  eckit::mpi::setCommDefault(globalSpaceComm.name().c_str());
+
+  oops::Log::trace() << "ErrorCovariance::setupParallelHybrid done" << std::endl;
+}
+
+// -----------------------------------------------------------------------------
+
+template<typename MODEL>
+std::vector<double> ErrorCovariance<MODEL>::timeParallelHybridComponents(
+                                             const eckit::mpi::Comm & globalSpaceComm,
+                                             const State4D_ & xb) const {
+  oops::Log::trace() << "ErrorCovariance::timeParallelHybridComponents starting" << std::endl;
+
+  // Subcommunicator within component
+  const std::string spaceCommName = "comm_space_" + std::to_string(myComponent_);
+  const auto & localSpaceComm = eckit::mpi::comm(spaceCommName.c_str());
+  eckit::mpi::setCommDefault(localSpaceComm.name().c_str());
+
+  // Warm-up application on a constant FieldSet
+  oops::FieldSet4D fset4dCmp(xb.times(), xb.commTime(), localSpaceComm);
+  for (size_t jtime = 0; jtime < fset4dCmp.size(); ++jtime) {
+    fset4dCmp[jtime].init(hybridBlockChain_[0]->outerFunctionSpace(),
+                          hybridBlockChain_[0]->outerVariables(),
+                          1.0);
+  }
+  eckit::Timer timer;
+  hybridBlockChain_[0]->multiply(fset4dCmp);
+  std::vector<double> times(hybridComponentTasks_.size(), 0.0);
+  times[myComponent_] = timer.elapsed();
+
+  // Set back default MPI communicator
+  eckit::mpi::setCommDefault(globalSpaceComm.name().c_str());
+
+  // Slowest task of each component
+  globalSpaceComm.allReduceInPlace(times.data(), times.size(), eckit::mpi::max());
+  for (size_t jc = 0; jc < times.size(); ++jc) {
+    oops::Log::info() << "Info     : Hybrid component " << jc + 1 << " warm-up time: "
+                      << times[jc] << " s with " << hybridComponentTasks_[jc] << " MPI tasks"
+                      << std::endl;
+  }
+
+  oops::Log::trace() << "ErrorCovariance::timeParallelHybridComponents done" << std::endl;
+  return times;
+}
+// -----------------------------------------------------------------------------
+
 template<typename MODEL>
 ErrorCovariance<MODEL>::~ErrorCovariance() {
   oops::Log::trace() << "ErrorCovariance<MODEL>::~ErrorCovariance starting" << std::endl;
   util::Timer timer(classname(), "~ErrorCovariance");
+  if (parallelHybrid_ && hybridApplications_ > 0) {
+    // Component timings (slowest task of each component), to help balancing the number of
+    // MPI tasks per component
+    eckit::mpi::comm(globalSpaceCommName_.c_str()).allReduceInPlace(
+      hybridComponentTimes_.data(), hybridComponentTimes_.size(), eckit::mpi::max());
+    for (size_t jc = 0; jc < hybridComponentTimes_.size(); ++jc) {
+      oops::Log::info() << "Info     : Hybrid component " << jc + 1 << ": "
+                        << hybridComponentTimes_[jc]/static_cast<double>(hybridApplications_)
+                        << " s per multiplication with " << hybridComponentTasks_[jc]
+                        << " MPI tasks" << std::endl;
+    }
+  }
   oops::Log::trace() << "ErrorCovariance<MODEL>::~ErrorCovariance done" << std::endl;
 }
 
@@ -542,8 +741,6 @@ void ErrorCovariance<MODEL>::doRandomize(Increment4D_ & dx) const {
     }
 
     // Add components
-    globalSpaceComm.barrier();
-
     for (size_t jtime = 0; jtime < fset4dCmp.size(); jtime++) {
       // Redistribute to global communicator and sum
        util::gatherAndSumFromSubcommunicator(fset4dCmp[jtime].fieldSet(),
@@ -651,6 +848,7 @@ void ErrorCovariance<MODEL>::doMultiply(const Increment4D_ & dxi,
     }
 
     // Apply covariance
+    eckit::Timer cmpTimer;
     hybridBlockChain_[0]->multiply(fset4dCmp);
 
     // Apply weight
@@ -663,10 +861,10 @@ void ErrorCovariance<MODEL>::doMultiply(const Increment4D_ & dxi,
       fset4dCmp *= hybridFieldWeightSqrt_[0];
     }
 
-    // Wait for all components to have finished multiplying
-    globalSpaceComm.barrier();
+    const double cmpTime = cmpTimer.elapsed();
 
-    // Gather and sum data across components
+    // Gather and sum data across components (no barrier, each component starts as soon as it
+    // is done)
     for (size_t jtime = 0; jtime < fset4dCmp.size(); jtime++) {
       util::gatherAndSumFromSubcommunicator(fset4dCmp[jtime].fieldSet(),
                                             fset4dSum[jtime].fieldSet(),
@@ -676,6 +874,13 @@ void ErrorCovariance<MODEL>::doMultiply(const Increment4D_ & dxi,
                                             globalFunctionSpace);
     }
 
+    // Component timing on this task, reduced across components when the covariance is
+    // destroyed
+    oops::Log::debug() << "Hybrid component " << myComponent_ + 1 << " multiply time: "
+                       << cmpTime << " s" << std::endl;
+    hybridComponentTimes_[myComponent_] += cmpTime;
+    ++hybridApplications_;
+
     // Set back default MPI communicator
     eckit::mpi::setCommDefault(globalSpaceComm.name().c_str());
 
@@ -57,12 +57,27 @@ class ErrorCovarianceParameters : public oops::ModelSpaceCovarianceParametersBas
   oops::Parameter<std::string> timeCovariance{"time covariance", "multivariate duplicated",
                                               this};
 
+  // Reduction of the time slots over the time communicator for duplicated multivariate time
+  // covariance. Options: reduce (sum on the first task, then broadcast of the result),
+  // allreduce (sum on all tasks, no broadcast but redundant central block application).
+  oops::Parameter<std::string> timeCovarianceReduction{"time covariance reduction", "reduce",
+                                                       this};
+
   // Option to change resolution of the background to the increment geometry
   oops::Parameter<bool> changeBackgroundResolution{"change background resolution",
                         false, this};
 
   // Ensemble
   oops::Parameter<bool> iterativeEnsembleLoading{"iterative ensemble loading", false, this};
+  // Number of ensemble members read ahead, while the previous ones are processed, during
+  // iterative ensemble loading (0 for synchronous reads), and memory cap of the read batches (in
+  // MB, 0 for no cap). Prefetching requires a thread-safe model I/O, MPI_THREAD_FUNNELED support
+  // and outer blocks that do not communicate during the calibration; members are read
+  // synchronously otherwise.
+  oops::Parameter<size_t> iterativeEnsembleLoadingPrefetchDepth{
+                        "iterative ensemble loading prefetch depth", 0, this};
+  oops::Parameter<double> iterativeEnsembleLoadingPrefetchMemory{
+                        "iterative ensemble loading prefetch memory", 0.0, this};
   oops::OptionalParameter<eckit::LocalConfiguration> ensemble{"ensemble", this};
   oops::OptionalParameter<eckit::LocalConfiguration> ensemblePert{"ensemble pert", this};
   oops::OptionalParameter<eckit::LocalConfiguration> ensembleBase{"ensemble base", this};
@@ -71,6 +86,9 @@ class ErrorCovarianceParameters : public oops::ModelSpaceCovarianceParametersBas
                         "ensemble pert on other geometry", this};
   oops::OptionalParameter<eckit::LocalConfiguration> ensembleGeom{
                         "ensemble geometry", this};
+  // Name of the MPI communicator the members of "ensemble pert" are distributed over (set by the
+  // error covariance toolbox for parallel ensemble groups)
+  oops::OptionalParameter<std::string> ensembleComm{"ensemble communicator", this};
 
 
   // Dual resolution calibration
@@ -48,6 +48,7 @@
 #include "oops/util/parameters/Parameter.h"
 #include "oops/util/parameters/Parameters.h"
 #include "oops/util/parameters/RequiredParameter.h"
+#include "oops/util/Timer.h"
 
 #include "saber/oops/Utilities.h"
 #include "saber/util/HorizontalProfiles.h"
@@ -77,12 +78,26 @@ template <typename MODEL> class ErrorCovarianceToolboxParameters :
   /// Geometry parameters.
   oops::Parameter<bool> parallel{"parallel subwindows", true, this};
 
+  /// Number of groups of MPI tasks holding different ensemble members. Each group holds the full
+  /// geometry on its own tasks, and the ensemble members read from "ensemble pert" are
+  /// distributed over the groups, along the ensemble communicator. Ignored if the number of
+  /// tasks is not divisible by the number of groups. Outputs are written by the first group.
+  oops::Parameter<size_t> ensembleGroups{"parallel ensemble groups", 1, this};
+
   /// Outer variables parameters
   oops::OptionalParameter<oops::Variables> incrementVars{"increment variables", this};
 
   /// Dirac location/variables parameters.
   oops::OptionalParameter<eckit::LocalConfiguration> dirac{"dirac", this};
 
+  /// Minimum horizontal separation (m) between Dirac points applied together. If present, the
+  /// Dirac points are split into colour classes of points that are farther apart than this
+  /// distance, the covariance is applied once per class and the diagnostics at each Dirac point
+  /// are computed from the response of its own class only. This costs one covariance application
+  /// per class instead of a single one: it is meant for diagnostics that must not be polluted by
+  /// the responses of nearby Dirac points, not to speed up the Dirac test.
+  oops::OptionalParameter<double> diracSeparation{"dirac colouring separation", this};
+
   /// Diagnostic location/variables parameters.
   oops::OptionalParameter<eckit::LocalConfiguration> diagnostic{"diagnostic points", this};
 
@@ -99,6 +114,10 @@ template <typename MODEL> class ErrorCovarianceToolboxParameters :
   /// Where to write the output of randomized variance.
   oops::OptionalParameter<eckit::LocalConfiguration> outputVariance{"output variance", this};
 
+  /// Whether the randomized variance is centered on the sample mean (streaming Welford
+  /// estimate) instead of the expected zero mean of the perturbations.
+  oops::Parameter<bool> centeredVariance{"centered randomized variance", false, this};
+
   /// Whether and how to compute unidimensional covariance profiles for isotropic cases
   oops::OptionalParameter<eckit::LocalConfiguration> covarianceProfile{
                                     "covariance profile", this};
@@ -173,6 +192,38 @@ template <typename MODEL> class ErrorCovarianceToolbox : public oops::Applicatio
       ASSERT(commTime->size() == (nsubwin / nsublocal));
     }
 
+    // Define ensemble communicator
+    const eckit::mpi::Comm * commEns = nullptr;
+    size_t myEnsGroup = 0;
+    const size_t nEnsGroups = params.ensembleGroups.value();
+    if (nEnsGroups > 1) {
+      if (nsubwin > 1) {
+        throw eckit::UserError("parallel ensemble groups cannot be combined with time "
+                               "subwindows", Here());
+      }
+      const size_t ntasks = this->getComm().size();
+      if (ntasks % nEnsGroups == 0) {
+        myEnsGroup = this->getComm().rank() / (ntasks / nEnsGroups);
+
+        // Create a communicator for same ensemble group, to be used for communications in space
+        const std::string sgeom = "comm_geom_ens_" + std::to_string(myEnsGroup);
+        char const *geomName = sgeom.c_str();
+        commSpace = &this->getComm().split(myEnsGroup, geomName);
+
+        // Create a communicator for same local area, to be used for communications between
+        // ensemble members
+        const size_t myarea = commSpace->rank();
+        const std::string sens = "comm_ens_" + std::to_string(myarea);
+        char const *ensName = sens.c_str();
+        commEns = &this->getComm().split(myarea, ensName);
+        ASSERT(commEns->size() == nEnsGroups);
+      } else {
+        oops::Log::warning() << "Parallel ensemble groups specified in yaml "
+                             << "but number of tasks is not divisible by "
+                             << "the number of groups, ignoring." << std::endl;
+      }
+    }
+
     // Get number of MPI tasks and OpenMP threads
     size_t ntasks = commSpace->size();
     size_t nthreads = 1;
@@ -209,8 +260,27 @@ template <typename MODEL> class ErrorCovarianceToolbox : public oops::Applicatio
     const CovarianceParametersBase_ & covarParams
       = params.backgroundError.value().covarianceParameters;
 
+    // Background error covariance configuration, with the ensemble communicator
+    eckit::LocalConfiguration covarConf(covarParams.toConfiguration());
+    if (commEns != nullptr) {
+      covarConf.set("ensemble communicator", commEns->name());
+    }
+
     // Dirac test
     const auto & diracParams = params.dirac.value();
+    const auto & diracSeparation = params.diracSeparation.value();
+    if (diracSeparation != boost::none) {
+      // Dirac colouring is only defined for a single list of lon/lat Dirac points
+      if (diracParams == boost::none) {
+        throw eckit::UserError("dirac colouring separation requires a dirac configuration",
+                               Here());
+      }
+      if (!diracParams->has("lon") || !diracParams->has("lat")) {
+        throw eckit::UserError("dirac colouring separation requires a single dirac "
+                               "configuration with lon/lat points, 4D and list-style dirac "
+                               "configurations are not supported", Here());
+      }
+    }
     if (diracParams != boost::none) {
       // Setup Dirac field
       Increment4D_ dxi(geom, vars, xx.times(), *commTime);
@@ -223,36 +293,43 @@ template <typename MODEL> class ErrorCovarianceToolbox : public oops::Applicatio
       // Add dirac configuration
       testConf.set("dirac", *diracParams);
 
+      // Add Dirac colour classes
+      if (diracSeparation != boost::none) {
+        testConf.set("dirac classes", diracClasses(*diracParams, *diracSeparation));
+      }
+
       // Add diagnostic print configuration
       const auto & diagnostic = params.diagnostic.value();
       if (diagnostic != boost::none) {
         testConf.set("diagnostic points", *diagnostic);
       }
 
-      // Add output Dirac configuration
-      eckit::LocalConfiguration outputDiracUpdated = params.outputDirac.value().value();
-      setMPI(outputDiracUpdated, ntasks);
-      testConf.set("output dirac", outputDiracUpdated);
+      // Add output Dirac configuration (first ensemble group only)
+      if (myEnsGroup == 0) {
+        eckit::LocalConfiguration outputDiracUpdated = params.outputDirac.value().value();
+        setMPI(outputDiracUpdated, ntasks);
+        testConf.set("output dirac", outputDiracUpdated);
+      }
 
-      // Add covariance profile configuration
+      // Add covariance profile configuration (first ensemble group only)
       const auto & profileConfig = params.covarianceProfile.value();
-      if (profileConfig != boost::none) {
+      if ((profileConfig != boost::none) && (myEnsGroup == 0)) {
         testConf.set("covariance profile", *profileConfig);
       }
 
       // Apply B matrix components recursively
       std::string id;
-      dirac(covarParams.toConfiguration(), testConf, id, geom, vars, xx, dxi);
+      dirac(covarConf, testConf, id, geom, vars, xx, dxi);
     }
 
     const auto & randomizationSize = covarParams.randomizationSize.value();
     if ((diracParams == boost::none) || (randomizationSize != boost::none)) {
       // Background error covariance training
       std::unique_ptr<CovarianceBase_> Bmat(CovarianceFactory_::create(
-                                            geom, vars, covarParams, xx, xx));
+                                            geom, vars, covarConf, xx, xx));
 
       // Randomization
-      randomization(params, geom, vars, xx, Bmat, ntasks);
+      randomization(params, geom, vars, xx, Bmat, ntasks, myEnsGroup == 0);
     }
 
     return 0;
@@ -381,6 +458,74 @@ template <typename MODEL> class ErrorCovarianceToolbox : public oops::Applicatio
   oops::Log::trace() << appname() << "::extract_1d_covariances done" << std::endl;
 }
 // -----------------------------------------------------------------------------
+// Greedy colouring of the Dirac points: each point goes to the first class where all points are
+// at least at the given horizontal distance, so that their responses do not interact.
+  std::vector<eckit::LocalConfiguration> diracClasses(const eckit::LocalConfiguration & diracConf,
+                                                      const double & separation) const {
+    oops::Log::trace() << appname() << "::diracClasses starting" << std::endl;
+
+    const std::vector<double> lon = diracConf.getDoubleVector("lon");
+    const std::vector<double> lat = diracConf.getDoubleVector("lat");
+    ASSERT(lat.size() == lon.size());
+
+    // Colour classes
+    std::vector<std::vector<size_t>> classes;
+    for (size_t jp = 0; jp < lon.size(); ++jp) {
+      const atlas::PointLonLat point(lon[jp], lat[jp]);
+      bool placed = false;
+      for (auto & indices : classes) {
+        bool isolated = true;
+        for (const auto & jq : indices) {
+          if (atlas::util::Earth().distance(point, atlas::PointLonLat(lon[jq], lat[jq]))
+            < separation) {
+            isolated = false;
+            break;
+          }
+        }
+        if (isolated) {
+          indices.push_back(jp);
+          placed = true;
+          break;
+        }
+      }
+      if (!placed) classes.push_back({jp});
+    }
+    oops::Log::info() << "Info     : " << lon.size() << " Dirac points split into "
+                      << classes.size() << " colour classes" << std::endl;
+
+    // Class configurations (other keys are copied as is)
+    std::vector<eckit::LocalConfiguration> classConfs;
+    for (const auto & indices : classes) {
+      eckit::LocalConfiguration classConf(diracConf);
+      std::vector<double> lonClass;
+      std::vector<double> latClass;
+      for (const auto & jp : indices) {
+        lonClass.push_back(lon[jp]);
+        latClass.push_back(lat[jp]);
+      }
+      classConf.set("lon", lonClass);
+      classConf.set("lat", latClass);
+      if (diracConf.has("level")) {
+        const std::vector<int> level = diracConf.getIntVector("level");
+        ASSERT(level.size() == lon.size());
+        std::vector<int> levelClass;
+        for (const auto & jp : indices) levelClass.push_back(level[jp]);
+        classConf.set("level", levelClass);
+      }
+      if (diracConf.has("variable")) {
+        const std::vector<std::string> variable = diracConf.getStringVector("variable");
+        ASSERT(variable.size() == lon.size());
+        std::vector<std::string> variableClass;
+        for (const auto & jp : indices) variableClass.push_back(variable[jp]);
+        classConf.set("variable", variableClass);
+      }
+      classConfs.push_back(classConf);
+    }
+
+    oops::Log::trace() << appname() << "::diracClasses done" << std::endl;
+    return classConfs;
+  }
+// -----------------------------------------------------------------------------
 // The passed geometry/variables should be consistent with the passed increment
   void dirac(const eckit::LocalConfiguration & covarConf,
              const eckit::LocalConfiguration & testConf,
@@ -396,8 +541,29 @@ template <typename MODEL> class ErrorCovarianceToolbox : public oops::Applicatio
     std::unique_ptr<CovarianceBase_> Bmat(CovarianceFactory_::create(
                                           geom, vars, covarConf, xx, xx));
 
+    // Dirac points applied together (all of them by default)
+    std::vector<eckit::LocalConfiguration> classConfs;
+    if (testConf.has("dirac classes")) {
+      classConfs = testConf.getSubConfigurations("dirac classes");
+    } else {
+      classConfs.push_back(testConf.getSubConfiguration("dirac"));
+    }
+
     // Multiply
-    Bmat->multiply(dxi, dxo);
+    std::vector<std::unique_ptr<Increment4D_>> dxoClasses;
+    if (classConfs.size() == 1) {
+      Bmat->multiply(dxi, dxo);
+    } else {
+      // One application per colour class, the total response is the sum of the class responses
+      dxo.zero();
+      for (const auto & classConf : classConfs) {
+        Increment4D_ dxiClass(dxi, false);
+        dxiClass.dirac(classConf);
+        dxoClasses.emplace_back(std::make_unique<Increment4D_>(dxi, false));
+        Bmat->multiply(dxiClass, *dxoClasses.back());
+        dxo += *dxoClasses.back();
+      }
+    }
 
     // Update ID
     if (id != "") id.append("_");
@@ -408,7 +574,21 @@ template <typename MODEL> class ErrorCovarianceToolbox : public oops::Applicatio
 
       // Print variances
       oops::Log::test() << "- Variances at Dirac points:" << std::endl;
-      print_value_at_positions(testConf.getSubConfiguration("dirac"), geom, dxo);
+      if (dxoClasses.empty()) {
+        print_value_at_positions(testConf.getSubConfiguration("dirac"), geom, dxo);
+      } else {
+        // Gather the response of each class at its own Dirac points, so that the values are
+        // printed in the order of the input Dirac points
+        Increment4D_ dxv(dxi, false);
+        dxv.zero();
+        for (size_t jc = 0; jc < classConfs.size(); ++jc) {
+          Increment4D_ dxvClass(dxi, false);
+          dxvClass.dirac(classConfs[jc]);
+          dxvClass.schur_product_with(*dxoClasses[jc]);
+          dxv += dxvClass;
+        }
+        print_value_at_positions(testConf.getSubConfiguration("dirac"), geom, dxv);
+      }
 
       // Print covariances
       oops::Log::test() << "- Covariances at diagnostic points:" << std::endl;
@@ -423,20 +603,33 @@ template <typename MODEL> class ErrorCovarianceToolbox : public oops::Applicatio
       // Seek and replace %id% with id, recursively
       util::seekAndReplace(covProfileConf, "%id%", id);
 
-      extract_1d_covariances(testConf.getSubConfiguration("dirac"),
-                             covProfileConf,
-                             geom,
-                             dxo);
+      if (dxoClasses.empty()) {
+        extract_1d_covariances(testConf.getSubConfiguration("dirac"),
+                               covProfileConf,
+                               geom,
+                               dxo);
+      } else {
+        for (size_t jc = 0; jc < classConfs.size(); ++jc) {
+          eckit::LocalConfiguration classProfileConf(covProfileConf);
+          if (classProfileConf.has("output filepath")) {
+            classProfileConf.set("output filepath", covProfileConf.getString("output filepath")
+                                 + "_class" + std::to_string(jc+1));
+          }
+          extract_1d_covariances(classConfs[jc], classProfileConf, geom, *dxoClasses[jc]);
+        }
+      }
     }
 
-    // Copy configuration
-    eckit::LocalConfiguration outputBConf(testConf.getSubConfiguration("output dirac"));
+    if (testConf.has("output dirac")) {
+      // Copy configuration
+      eckit::LocalConfiguration outputBConf(testConf.getSubConfiguration("output dirac"));
 
-    // Seek and replace %id% with id, recursively
-    util::seekAndReplace(outputBConf, "%id%", id);
+      // Seek and replace %id% with id, recursively
+      util::seekAndReplace(outputBConf, "%id%", id);
 
-    // Write output increment
-    dxo[0].write(outputBConf);
+      // Write output increment
+      dxo[0].write(outputBConf);
+    }
     oops::Log::test() << "Covariance(" << id << ") * Increment:" << dxo << std::endl;
 
     // Look for hybrid or ensemble covariance models
@@ -508,14 +701,16 @@ template <typename MODEL> class ErrorCovarianceToolbox : public oops::Applicatio
         print_value_at_positions(testConf.getSubConfiguration("diagnostic points"), geom, dxo);
       }
 
-      // Copy configuration
-      eckit::LocalConfiguration outputLConf(testConf.getSubConfiguration("output dirac"));
+      if (testConf.has("output dirac")) {
+        // Copy configuration
+        eckit::LocalConfiguration outputLConf(testConf.getSubConfiguration("output dirac"));
 
-      // Seek and replace %id% with id, recursively
-      util::seekAndReplace(outputLConf, "%id%", idL);
+        // Seek and replace %id% with id, recursively
+        util::seekAndReplace(outputLConf, "%id%", idL);
 
-      // Write output increment
-      dxo[0].write(outputLConf);
+        // Write output increment
+        dxo[0].write(outputLConf);
+      }
       oops::Log::test() << "Localization(" << id << ") * Increment:" << dxo << std::endl;
     }
   }
@@ -525,7 +720,8 @@ template <typename MODEL> class ErrorCovarianceToolbox : public oops::Applicatio
                      const oops::Variables & vars,
                      const State4D_ & xx,
                      const std::unique_ptr<CovarianceBase_> & Bmat,
-                     const size_t & ntasks) const {
+                     const size_t & ntasks,
+                     const bool & writeOutput) const {
     if (Bmat->randomizationSize() > 0) {
       oops::Log::info() << "Info     : " << std::endl;
       oops::Log::info() << "Info     : Generate perturbations:" << std::endl;
@@ -539,51 +735,62 @@ template <typename MODEL> class ErrorCovarianceToolbox : public oops::Applicatio
       // Initialize variance
       variance.zero();
 
-      // Create empty ensemble
-      std::vector<Increment_> ens;
+      // Running mean for the centered variance (Welford)
+      const bool centeredVariance = params.centeredVariance.value();
+      std::unique_ptr<Increment4D_> mean;
+      if (centeredVariance) {
+        mean.reset(new Increment4D_(geom, vars, xx.times(), xx.commTime()));
+        mean->zero();
+      }
 
       // Output options
       const auto & outputPerturbations = params.outputPerturbations.value();
       const auto & outputStates = params.outputStates.value();
       const auto & outputVariance = params.outputVariance.value();
 
+      // Members are processed one at a time (statistics accumulated and outputs written as
+      // soon as each member is generated), so that memory does not depend on the number of
+      // members
       for (size_t jm = 0; jm < Bmat->randomizationSize(); ++jm) {
         // Generate member
         oops::Log::info() << "Info     : Member " << jm << std::endl;
-        Bmat->randomize(dx);
-
-        if ((outputPerturbations != boost::none) || (outputStates != boost::none)) {
-          // Save member
-          ens.push_back(dx[0]);
+        {
+          util::Timer timer("saber::ErrorCovarianceToolbox", "randomize");
+          Bmat->randomize(dx);
         }
 
-        // Square perturbation
-        dxsq = dx;
-        dxsq.schur_product_with(dx);
+        if (centeredVariance) {
+          // Welford update of the mean and of the sum of squared deviations
+          dxsq = dx;
+          dxsq -= *mean;
+          mean->axpy(1.0/static_cast<double>(jm+1), dxsq);
+          Increment4D_ dxdev(dx);
+          dxdev -= *mean;
+          dxsq.schur_product_with(dxdev);
+        } else {
+          // Square perturbation
+          dxsq = dx;
+          dxsq.schur_product_with(dx);
+        }
 
         // Update variance
         variance += dxsq;
-      }
-      oops::Log::info() << "Info     : " << std::endl;
 
-      if ((outputPerturbations != boost::none) || (outputStates != boost::none)) {
-        oops::Log::info() << "Info     : Write states and/or perturbations:" << std::endl;
-        oops::Log::info() << "Info     : ----------------------------------" << std::endl;
-        oops::Log::info() << "Info     : " << std::endl;
-        for (size_t jm = 0; jm < Bmat->randomizationSize(); ++jm) {
-          oops::Log::test() << "Member " << jm << ": " << ens[jm] << std::endl;
+        if ((outputPerturbations != boost::none) || (outputStates != boost::none)) {
+          util::Timer timer("saber::ErrorCovarianceToolbox", "writeMember");
+          oops::Log::test() << "Member " << jm << ": " << dx[0] << std::endl;
 
-          if (outputPerturbations != boost::none) {
+          if ((outputPerturbations != boost::none) && writeOutput) {
             // Update config
             auto outputPerturbationsUpdated = *outputPerturbations;
             util::setMember(outputPerturbationsUpdated, jm+1);
             setMPI(outputPerturbationsUpdated, ntasks);
 
             // Write perturbation
-            ens[jm].write(outputPerturbationsUpdated);
+            dx[0].write(outputPerturbationsUpdated);
           }
 
-          if (outputStates != boost::none) {
+          if ((outputStates != boost::none) && writeOutput) {
             // Update config
             auto outputStatesUpdated = *outputStates;
             util::setMember(outputStatesUpdated, jm+1);
@@ -591,21 +798,26 @@ template <typename MODEL> class ErrorCovarianceToolbox : public oops::Applicatio
 
             // Add background state to perturbation
             State_ xp(xx[0]);
-            xp += ens[jm];
+            xp += dx[0];
 
             // Write state
             xp.write(outputStatesUpdated);
           }
-
-          oops::Log::info() << "Info     : " << std::endl;
         }
       }
+      oops::Log::info() << "Info     : " << std::endl;
 
       if (outputVariance != boost::none) {
         oops::Log::info() << "Info     : Write randomized variance:" << std::endl;
         oops::Log::info() << "Info     : --------------------------" << std::endl;
         oops::Log::info() << "Info     : " << std::endl;
-        if (Bmat->randomizationSize() > 1) {
+        if (centeredVariance) {
+          // Normalize sum of squared deviations (unbiased estimate)
+          if (Bmat->randomizationSize() > 1) {
+            double rk_norm = 1.0/static_cast<double>(Bmat->randomizationSize()-1);
+            variance *= rk_norm;
+          }
+        } else if (Bmat->randomizationSize() > 1) {
           // Normalize variance
           double rk_norm = 1.0/static_cast<double>(Bmat->randomizationSize());
           variance *= rk_norm;
@@ -616,7 +828,7 @@ template <typename MODEL> class ErrorCovarianceToolbox : public oops::Applicatio
         setMPI(outputVarianceUpdated, ntasks);
 
         // Write variance
-        variance[0].write(outputVarianceUpdated);
+        if (writeOutput) variance[0].write(outputVarianceUpdated);
         oops::Log::test() << "Randomized variance: " << variance << std::endl;
       }
     }
@@ -35,6 +35,7 @@
 #include "oops/util/parameters/Parameter.h"
 #include "oops/util/parameters/Parameters.h"
 #include "oops/util/parameters/RequiredParameter.h"
+#include "oops/util/Timer.h"
 
 #include "saber/blocks/SaberParametricBlockChain.h"
 #include "saber/oops/ErrorCovarianceParameters.h"
@@ -165,6 +166,10 @@ template <typename MODEL> class ProcessPertsParameters :
   /// Where to read input ensemble: From states or perturbations
   oops::OptionalParameter<eckit::LocalConfiguration> ensemble{"ensemble", this};
   oops::OptionalParameter<eckit::LocalConfiguration> ensemblePert{"ensemble pert", this};
+
+  /// Number of groups of MPI tasks processing different members concurrently (each group
+  /// holding the full geometry)
+  oops::Parameter<size_t> ensembleGroups{"number of ensemble groups", 1, this};
 };
 
 // -----------------------------------------------------------------------------
@@ -181,6 +186,7 @@ template <typename MODEL> class ProcessPerts : public oops::Application {
   typedef ProcessPertsParameters<MODEL>                     ProcessPertsParameters_;
 
  public:
+  static const std::string classname() {return "saber::ProcessPerts";}
 // -----------------------------------------------------------------------------
   explicit ProcessPerts(const eckit::mpi::Comm & comm = eckit::mpi::comm()) :
     Application(comm) {
@@ -200,6 +206,27 @@ template <typename MODEL> class ProcessPerts : public oops::Application {
     const eckit::mpi::Comm * commSpace = &this->getComm();
     const eckit::mpi::Comm * commTime = &oops::mpi::myself();
 
+    // Define ensemble groups, each one processing a subset of the members
+    size_t ngroups = params.ensembleGroups.value();
+    size_t mygroup = 0;
+    if (ngroups > 1) {
+      const size_t ntasks = this->getComm().size();
+      if (ntasks % ngroups == 0) {
+        mygroup = this->getComm().rank() / (ntasks / ngroups);
+        ASSERT(mygroup < ngroups);
+
+        // Create a communicator for same ensemble group, to be used for communications in space
+        const std::string sgeom = "comm_geom_" + std::to_string(mygroup);
+        char const *geomName = sgeom.c_str();
+        commSpace = &this->getComm().split(mygroup, geomName);
+      } else {
+        oops::Log::warning() << "Number of ensemble groups specified in yaml "
+                             << "but number of tasks is not divisible by "
+                             << "the number of groups, ignoring." << std::endl;
+        ngroups = 1;
+      }
+    }
+
     // Setup geometry
     const Geometry_ geom(params.geometry, *commSpace, *commTime);
 
@@ -244,8 +271,9 @@ template <typename MODEL> class ProcessPerts : public oops::Application {
        Here());
     }
 
-    // Read input ensemble
-    const bool iterativeEnsembleLoading = false;
+    // Read input ensemble. Perturbations are read one member at a time when they are needed,
+    // while states are all read to remove the ensemble mean
+    const bool iterativeEnsembleLoading = (params.ensemblePert.value() != boost::none);
     eckit::LocalConfiguration ensembleConf(fullConfig);
     eckit::LocalConfiguration outputEnsConf;
     oops::FieldSets fsetEnsI = readEnsemble<MODEL>(geom,
@@ -254,7 +282,8 @@ template <typename MODEL> class ProcessPerts : public oops::Application {
                                                    ensembleConf,
                                                    iterativeEnsembleLoading,
                                                    outputEnsConf);
-    int nincrements = fsetEnsI.ens_size();
+    const int nincrements = iterativeEnsembleLoading ? outputEnsConf.getInt("ensemble size")
+                                                     : fsetEnsI.ens_size();
 
     const std::size_t nbands = params.bands.value().size();
     const std::vector<eckit::LocalConfiguration> bandsConfs
@@ -318,14 +347,31 @@ template <typename MODEL> class ProcessPerts : public oops::Application {
                                                     value));
     }
 
-    //  Loop over perturbations
-    for (int jm = 0; jm < nincrements; ++jm) {
-      oops::FieldSet3D fsetI(fsetEnsI[jm]);
+    // Norms of the perturbations and band perturbations, printed after the loop over members
+    // if members are processed by several ensemble groups
+    std::vector<double> norms(nincrements*(nbands+1), 0.0);
+    const auto testNorm = [&](const int & jm, const size_t & jb, const double & norm) {
+      if (ngroups == 1) {
+        printNorm(jm, jb, norm);
+      } else if (commSpace->rank() == 0) {
+        norms[jm*(nbands+1)+jb] = norm;
+      }
+    };
+
+    //  Loop over perturbations (distributed over ensemble groups)
+    for (int jm = mygroup; jm < nincrements; jm += ngroups) {
+      util::Timer timer(classname(), "member");
+      oops::FieldSet3D fsetI(iterativeEnsembleLoading ? time : fsetEnsI[jm].validTime(),
+                             geom.getComm());
+      if (iterativeEnsembleLoading) {
+        util::Timer timer(classname(), "read");
+        readEnsembleMember(geom, incVars, outputEnsConf, jm, fsetI);
+      } else {
+        fsetI.shallowCopy(fsetEnsI[jm].fieldSet());
+      }
       oops::FieldSet4D fset4dDxI(fsetI);
 
-      oops::Log::test() << "Norm of perturbation: "
-                        << "member " << jm+1
-                        << ": " << fsetI.norm(fsetI.variables()) << std::endl;
+      testNorm(jm, 0, fsetI.norm(fsetI.variables()));
 
       oops::FieldSet3D fsetSum(fsetI.validTime(), fsetI.commGeom());
       fsetSum.allocateOnly(fsetI.fieldSet());
@@ -342,6 +388,7 @@ template <typename MODEL> class ProcessPerts : public oops::Application {
         // Apply filter blocks
         if (auto it{filterCovBlockConfs.find(b)}; it != std::end(filterCovBlockConfs)) {
           const std::size_t idx = std::distance(std::begin(filterCovBlockConfs), it);
+          util::Timer timer(classname(), "filter");
           saberFilterBlocks[idx]->filter(fset4dDx);
           if (calcComplement[b]) {
             fset4dDx[0] -= fset4dDxI[0];
@@ -356,10 +403,7 @@ template <typename MODEL> class ProcessPerts : public oops::Application {
 
         fset4dDxSum += fset4dDx;
 
-        oops::Log::test() << "Norm of band perturbation: "
-                          << "member " << jm+1 << ": band " << b+1
-                          << ": " << fset4dDx[0].norm(fset4dDx[0].variables())
-                          << std::endl;
+        testNorm(jm, b+1, fset4dDx[0].norm(fset4dDx[0].variables()));
 
 
         // Apply diagnostic blocks
@@ -375,6 +419,7 @@ template <typename MODEL> class ProcessPerts : public oops::Application {
                                 std::vector<std::string>{"geometry", "grid"},
                                 "grid pattern",
                                 gconf);
+          util::Timer timer(classname(), "write");
           util::writeFieldSet(geom.getComm(), gconf, fset4dDx[0].fieldSet());
         }
 
@@ -391,11 +436,22 @@ template <typename MODEL> class ProcessPerts : public oops::Application {
           IncrementWriteParameters_ writeParams;
           writeParams.deserialize(mconf);
           writeParams.setMember(jm+1);
+          util::Timer timer(classname(), "write");
           pert.write(writeParams);
         }
       }
     }
 
+    if (ngroups > 1) {
+      // Gather norms from the first task of each group and print them in the member order
+      this->getComm().allReduceInPlace(norms.data(), norms.size(), eckit::mpi::sum());
+      for (int jm = 0; jm < nincrements; ++jm) {
+        for (size_t jb = 0; jb < nbands+1; ++jb) {
+          printNorm(jm, jb, norms[jm*(nbands+1)+jb]);
+        }
+      }
+    }
+
     return 0;
   }
 // -----------------------------------------------------------------------------
@@ -413,6 +469,20 @@ template <typename MODEL> class ProcessPerts : public oops::Application {
   std::string appname() const override {
     return "oops::ProcessPerts<" + MODEL::name() + ">";
   }
+// -----------------------------------------------------------------------------
+  /// Print norm of a perturbation (band 0) or of a band perturbation
+  void printNorm(const int & jm, const size_t & jb, const double & norm) const {
+    if (jb == 0) {
+      oops::Log::test() << "Norm of perturbation: "
+                        << "member " << jm+1
+                        << ": " << norm << std::endl;
+    } else {
+      oops::Log::test() << "Norm of band perturbation: "
+                        << "member " << jm+1 << ": band " << jb
+                        << ": " << norm
+                        << std::endl;
+    }
+  }
 };
 
 }  // namespace saber
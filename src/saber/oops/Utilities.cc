@@ -5,6 +5,8 @@
  * which can be obtained at http://www.apache.org/licenses/LICENSE-2.0.
  */
 
+#include <mpi.h>
+
 #include <string>
 #include <vector>
 
@@ -111,5 +113,17 @@ void allocateMissingFields(oops::FieldSet3D & fset,
 
 // -----------------------------------------------------------------------------
 
+bool mpiThreadFunneled() {
+  // MPI thread support level, as provided at initialization
+  int initialized = 0;
+  MPI_Initialized(&initialized);
+  if (initialized == 0) return false;
+  int provided = MPI_THREAD_SINGLE;
+  MPI_Query_thread(&provided);
+  return provided >= MPI_THREAD_FUNNELED;
+}
+
+// -----------------------------------------------------------------------------
+
 
 }  // namespace saber
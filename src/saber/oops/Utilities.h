@@ -7,8 +7,13 @@
 
 #pragma once
 
+#include <omp.h>
+
 #include <algorithm>
+#include <exception>
+#include <functional>
 #include <memory>
+#include <numeric>
 #include <sstream>
 #include <string>
 #include <utility>
@@ -21,7 +26,9 @@
 
 #include "eckit/config/Configuration.h"
 #include "eckit/exception/Exceptions.h"
+#include "eckit/mpi/Comm.h"
 
+#include "oops/base/FieldSet3D.h"
 #include "oops/base/FieldSets.h"
 #include "oops/base/Geometry.h"
 #include "oops/base/Increment.h"
@@ -38,16 +45,13 @@
 #include "oops/util/FieldSetOperations.h"
 #include "oops/util/FunctionSpaceHelpers.h"
 #include "oops/util/Logger.h"
+#include "oops/util/Timer.h"
 
 #include "saber/blocks/SaberBlockParametersBase.h"
 #include "saber/blocks/SaberCentralBlockBase.h"
 #include "saber/blocks/SaberOuterBlockBase.h"
 #include "saber/oops/ErrorCovarianceParameters.h"
 
-namespace oops {
-  class FieldSet3D;
-}
-
 namespace saber {
 
 // -----------------------------------------------------------------------------
@@ -84,6 +88,11 @@ void allocateMissingFields(oops::FieldSet3D & fset,
 
 // -----------------------------------------------------------------------------
 
+/// Whether MPI allows the master thread to communicate while other threads are running.
+bool mpiThreadFunneled();
+
+// -----------------------------------------------------------------------------
+
 template<typename MODEL>
 oops::FieldSets readEnsemble(const oops::Geometry<MODEL> & geom,
                              const oops::Variables & modelvars,
@@ -180,6 +189,13 @@ oops::FieldSets readEnsemble(const oops::Geometry<MODEL> & geom,
   // Set ensemble size
   outputConf.set("ensemble size", nens);
 
+  // Distributed ensemble members are only read from increments on disk, fully loaded
+  if (inputConf.has("ensemble communicator") && (ensembleFound > 0)
+    && (ensemblePert.empty() || iterativeEnsembleLoading)) {
+    throw eckit::NotImplemented("ensemble communicator only implemented for \"ensemble pert\" "
+                                "without iterative ensemble loading", Here());
+  }
+
   // Check number of ensembles in yaml
   ASSERT(ensembleFound <= 1);
 
@@ -205,6 +221,30 @@ oops::FieldSets readEnsemble(const oops::Geometry<MODEL> & geom,
     // Increment ensemble from increments on disk
     if (!ensemblePert.empty()) {
       oops::Log::info() << "Info     : Increment ensemble from increments on disk" << std::endl;
+      if (inputConf.has("ensemble communicator")) {
+        // Members distributed over the ensemble communicator, by contiguous blocks in the order
+        // of the communicator ranks
+        const eckit::mpi::Comm & commEns
+          = eckit::mpi::comm(inputConf.getString("ensemble communicator").c_str());
+        if (xb.size() > 1) {
+          throw eckit::NotImplemented("distributed ensemble members not implemented for "
+                                      "several time slots", Here());
+        }
+        ASSERT(nens >= commEns.size());
+        const size_t ie0 = commEns.rank()*nens/commEns.size();
+        const size_t ie1 = (commEns.rank()+1)*nens/commEns.size();
+        oops::Log::info() << "Info     : Read ensemble members " << ie0 << " to " << ie1-1
+                          << " on this ensemble task" << std::endl;
+        std::vector<int> members(ie1-ie0);
+        std::iota(members.begin(), members.end(), static_cast<int>(ie0));
+        oops::IncrementSet<MODEL> ensemble(geom, vars, xb.times(), xb.commTime(), members,
+                                           commEns);
+        for (size_t ie = ie0; ie < ie1; ++ie) {
+          ensemble(0, ie-ie0).read(ensemblePertParams.getIncrementParameters(ie));
+        }
+        oops::FieldSets fsetEns(ensemble);
+        return fsetEns;
+      }
       oops::IncrementSet<MODEL> ensemble(geom, vars, xb.times(),
                                          ensemblePertParams.toConfiguration(), xb.commTime());
       oops::FieldSets fsetEns(ensemble);
@@ -319,6 +359,8 @@ void readEnsembleMember(const oops::Geometry<MODEL> & geom,
                         oops::FieldSet3D & fset) {
   oops::Log::trace() << "readEnsembleMember starting" << std::endl;
 
+  // Serialized with the processing thread output when members are prefetched
+  # pragma omp critical(saber_ensemble_log)
   oops::Log::info() << "Info     : Read ensemble member " << ie << std::endl;
 
   // Fill FieldSet
@@ -388,6 +430,132 @@ void readEnsembleMember(const oops::Geometry<MODEL> & geom,
   oops::Log::trace() << "readEnsembleMember done" << std::endl;
 }
 
+// -----------------------------------------------------------------------------
+
+/// Apply a function to all ensemble members read for iterative ensemble loading, in the order
+/// of the ensemble. With a positive prefetch depth, the next batch of "depth" members is read
+/// by the master thread while another thread processes the current batch. The memory cap (in
+/// MB, non-positive for no cap) bounds the two batches in memory, with at least one member per
+/// batch. All the MPI calls of the reads are then made by the master thread: the processing
+/// function must not communicate, and MPI must be initialized with at least
+/// MPI_THREAD_FUNNELED, otherwise the members are read synchronously. Log output of the
+/// processing function must be made in the saber_ensemble_log OpenMP critical section, as the
+/// reads do. A zero depth (the default) reads members synchronously.
+template<typename MODEL>
+void forEachEnsembleMember(const oops::Geometry<MODEL> & geom,
+                           const oops::Variables & vars,
+                           const eckit::LocalConfiguration & conf,
+                           const util::DateTime & validTime,
+                           const size_t & nens,
+                           const size_t & depth,
+                           const double & memoryCap,
+                           const std::function<void(oops::FieldSet3D &)> & process) {
+  oops::Log::trace() << "forEachEnsembleMember starting" << std::endl;
+
+  // Prefetch requires MPI calls from the master thread while the processing thread is running
+  size_t prefetchDepth = depth;
+  if (prefetchDepth > 0 && !mpiThreadFunneled()) {
+    oops::Log::info() << "Info     : Warning: MPI thread support is below MPI_THREAD_FUNNELED, "
+                      << "ensemble members are read synchronously" << std::endl;
+    oops::Log::test() << "Ensemble members read synchronously" << std::endl;
+    prefetchDepth = 0;
+  }
+
+  if (prefetchDepth == 0) {
+    // Synchronous reads
+    for (size_t ie = 0; ie < nens; ++ie) {
+      oops::FieldSet3D fset(validTime, geom.getComm());
+      readEnsembleMember(geom, vars, conf, ie, fset);
+      process(fset);
+    }
+  } else {
+    util::Timer timer("saber::forEachEnsembleMember", "prefetch");
+
+    // Read a batch of members
+    const auto readBatch = [&](const size_t & ieBegin, const size_t & ieEnd,
+                               std::vector<std::unique_ptr<oops::FieldSet3D>> & batch) {
+      batch.clear();
+      for (size_t ie = ieBegin; ie < ieEnd; ++ie) {
+        batch.emplace_back(new oops::FieldSet3D(validTime, geom.getComm()));
+        readEnsembleMember(geom, vars, conf, ie, *batch.back());
+      }
+    };
+
+    // First member, read synchronously to size the batches
+    std::vector<std::unique_ptr<oops::FieldSet3D>> current;
+    std::vector<std::unique_ptr<oops::FieldSet3D>> next;
+    readBatch(0, std::min(nens, static_cast<size_t>(1)), current);
+    size_t batchSize = prefetchDepth;
+    if (memoryCap > 0.0 && !current.empty()) {
+      size_t memberBytes = 0;
+      for (const auto & field : current[0]->fieldSet()) {
+        memberBytes += field.bytes();
+      }
+      const double maxMembers = memoryCap*1024.0*1024.0/static_cast<double>(2*memberBytes);
+      batchSize = std::max(static_cast<size_t>(1),
+                           std::min(prefetchDepth, static_cast<size_t>(maxMembers)));
+    }
+    oops::Log::info() << "Info     : Prefetch ensemble members by batches of " << batchSize
+                      << std::endl;
+    oops::Log::test() << "Ensemble members prefetched by batches of " << batchSize << std::endl;
+
+    // Nested parallelism, so that the processing thread can still use OpenMP loops
+#ifdef _OPENMP
+    const int maxActiveLevels = omp_get_max_active_levels();
+    omp_set_max_active_levels(std::max(maxActiveLevels, 2));
+#endif
+
+    // Pipeline
+    size_t ieCurrent = 0;
+    while (!current.empty()) {
+      const size_t ieNext = ieCurrent+current.size();
+      const size_t ieNextEnd = std::min(nens, ieNext+batchSize);
+      oops::Log::info() << "Info     : Use ensemble members " << ieCurrent << " to "
+                        << ieNext-1 << std::endl;
+      std::exception_ptr readError;
+      std::exception_ptr processError;
+      # pragma omp parallel num_threads(2)
+      {
+        // The master thread reads (and makes all the MPI calls), the other one processes. With
+        // a single thread, both tasks are done in turn.
+        int thread = 0;
+        int nThreads = 1;
+#ifdef _OPENMP
+        thread = omp_get_thread_num();
+        nThreads = omp_get_num_threads();
+#endif
+        if (thread == 0) {
+          try {
+            readBatch(ieNext, ieNextEnd, next);
+          } catch (...) {
+            readError = std::current_exception();
+          }
+        }
+        if (thread == nThreads-1) {
+          try {
+            for (auto & fset : current) {
+              process(*fset);
+            }
+          } catch (...) {
+            processError = std::current_exception();
+          }
+        }
+      }
+      if (processError) std::rethrow_exception(processError);
+      if (readError) std::rethrow_exception(readError);
+      current.swap(next);
+      ieCurrent = ieNext;
+    }
+
+#ifdef _OPENMP
+    omp_set_max_active_levels(maxActiveLevels);
+#endif
+  }
+
+  oops::Log::trace() << "forEachEnsembleMember done" << std::endl;
+}
+
+
 // -----------------------------------------------------------------------------
 
 }  // namespace saber
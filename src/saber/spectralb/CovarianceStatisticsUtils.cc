@@ -28,6 +28,7 @@
 #include "oops/mpi/mpi.h"
 #include "oops/util/AtlasArrayUtil.h"
 #include "oops/util/Logger.h"
+#include "oops/util/Timer.h"
 
 #include "saber/spectralb/spectralb_covstats_interface.h"
 #include "saber/spectralb/spectralbParameters.h"
@@ -537,50 +538,102 @@ void readSpectralCovarianceFromFile(const std::string & varname1,
 }
 
 
+namespace {
+
+/// Apply a levels x levels matrix per total wavenumber n1 to all the spectral coefficients
+/// sharing n1 (all local zonal wavenumbers, real and imaginary parts). These coefficients are
+/// gathered into a levels x coefficients panel and multiplied by the matrix with one BLAS
+/// GEMM per n1, so that each matrix is read once per n1.
+/// The matrices are stored contiguously in row-major order (n1, row, column), i.e. as
+/// transposed column-major matrices: the matrix itself is applied if transpose is false,
+/// its transpose otherwise, without any copy. The product is scaled by 1/norm(n1).
+template <typename Norm>
+void verticalConvolutionByWavenumber(const atlas::functionspace::Spectral & specFunctionSpace,
+                                     const double * matrices,
+                                     const bool transpose,
+                                     const Norm & norm,
+                                     atlas::Field & field) {
+  const std::size_t N = specFunctionSpace.truncation();
+  const auto zonal_wavenumbers = specFunctionSpace.zonal_wavenumbers();
+  const idx_t nb_zonal_wavenumbers = zonal_wavenumbers.size();
+  const int levels = field.shape(1);
+  auto spfView = make_view<double, 2>(field);
+
+  // Index of the first coefficient of each local zonal wavenumber
+  std::vector<idx_t> offsets(nb_zonal_wavenumbers+1, 0);
+  for (idx_t jm = 0; jm < nb_zonal_wavenumbers; ++jm) {
+    offsets[jm+1] = offsets[jm]+2*(N+1-zonal_wavenumbers(jm));
+  }
+
+  // Row-major storage seen by the column-major GEMM is the transpose
+  const char trans = transpose ? 'N' : 'T';
+  const double beta = 0.0;
+
+  #pragma omp parallel
+  {
+    std::vector<double> panel;
+    std::vector<double> result;
+
+    #pragma omp for schedule(dynamic)
+    for (std::size_t n1 = 0; n1 <= N; ++n1) {
+      // Gather coefficients of total wavenumber n1
+      std::vector<idx_t> indices;
+      for (idx_t jm = 0; jm < nb_zonal_wavenumbers; ++jm) {
+        const std::size_t m1 = zonal_wavenumbers(jm);
+        if (m1 <= n1) {
+          // Real and imaginary parts
+          indices.push_back(offsets[jm]+2*(n1-m1));
+          indices.push_back(offsets[jm]+2*(n1-m1)+1);
+        }
+      }
+      const int nc = indices.size();
+      if (nc == 0) continue;
+
+      // Column-major levels x coefficients panel (one contiguous column per coefficient)
+      panel.resize(levels*nc);
+      result.resize(levels*nc);
+      for (int jc = 0; jc < nc; ++jc) {
+        for (int jl = 0; jl < levels; ++jl) {
+          panel[jc*levels+jl] = spfView(indices[jc], jl);
+        }
+      }
+
+      // Matrix-panel product
+      const double alpha = 1.0/norm(n1);
+      dgemm_(trans, 'N', levels, nc, levels, alpha, matrices+n1*levels*levels, levels,
+             panel.data(), levels, beta, result.data(), levels);
+
+      // Scatter coefficients
+      for (int jc = 0; jc < nc; ++jc) {
+        for (int jl = 0; jl < levels; ++jl) {
+          spfView(indices[jc], jl) = result[jc*levels+jl];
+        }
+      }
+    }
+  }
+}
+
+}  // namespace
+
+
 void spectralVerticalConvolution(const oops::Variables & activeVars,
                                  const atlas::functionspace::Spectral & specFunctionSpace,
                                  const atlas::FieldSet & spectralVerticalStats,
                                  atlas::FieldSet & fieldSet) {
-  const size_t N = specFunctionSpace.truncation();
-
-  const auto zonal_wavenumbers = specFunctionSpace.zonal_wavenumbers();
-  const idx_t nb_zonal_wavenumbers = zonal_wavenumbers.size();
+  util::Timer timer("saber::spectralb::specutils", "spectralVerticalConvolution");
 
   // Only update the fields that were specified in the active variables
   for (const auto & var : activeVars) {
-    idx_t i = 0;
-    idx_t levels(fieldSet[var.name()].shape(1));
-    auto vertCovView = make_view<const double, 3>(spectralVerticalStats[var.name()]);
-    auto spfView = make_view<double, 2>(fieldSet[var.name()]);
+    const auto vertCovView = make_view<const double, 3>(spectralVerticalStats[var.name()]);
+    ASSERT(vertCovView.contiguous());
+    const idx_t nSpectralBinsFull = vertCovView.shape(0);
 
-    std::vector<double> col(levels), col2(levels);
     // For each total wavenumber n1, perform a 1D convolution with vertical covariances.
-    for (idx_t jm = 0; jm < nb_zonal_wavenumbers; ++jm) {
-      const idx_t m1 = zonal_wavenumbers(jm);
-      for (std::size_t n1 = m1; n1 <= N; ++n1) {
-        // Note that img stands for imaginary component and are the
-        // odd indices in the first index of the spectral fields.
-        for (std::size_t img = 0; img < 2; ++img) {
-          // Pre-fill vertical column to be convolved.
-          for (idx_t jl = 0; jl < levels; ++jl) {
-            col[jl] = spfView(i, jl);
-          }
-          // The 2*n1+1 factor is there to equally distribute the covariance across
-          // the spectral coefficients associated to this total wavenumber.
-          const double norm = static_cast<double>((2 * n1 + 1) * vertCovView.shape(0));
-          for (idx_t r = 0; r < levels; ++r) {
-            col2[r] = 0;
-            for (idx_t c = 0; c < levels; ++c) {
-              col2[r] += vertCovView(n1, r, c) * col[c] / norm;
-            }
-          }
-          for  (idx_t jl = 0; jl < levels; ++jl) {
-            spfView(i, jl) = col2[jl];
-          }
-          ++i;
-        }
-      }
-    }
+    // The 2*n1+1 factor is there to equally distribute the covariance across
+    // the spectral coefficients associated to this total wavenumber.
+    verticalConvolutionByWavenumber(specFunctionSpace, vertCovView.data(), false,
+      [&](const std::size_t n1) {return static_cast<double>((2 * n1 + 1) * nSpectralBinsFull);},
+      fieldSet[var.name()]);
   }
 }
 
@@ -589,42 +642,18 @@ void spectralVerticalConvolutionSqrt(const oops::Variables & activeVars,
                                      const atlas::functionspace::Spectral & specFunctionSpace,
                                      const atlas::FieldSet & spectralVerticalStatsSqrt,
                                      atlas::FieldSet & fieldSet) {
-  const size_t N = specFunctionSpace.truncation();
-
-  const auto zonal_wavenumbers = specFunctionSpace.zonal_wavenumbers();
-  const idx_t nb_zonal_wavenumbers = zonal_wavenumbers.size();
+  util::Timer timer("saber::spectralb::specutils", "spectralVerticalConvolutionSqrt");
 
   // Only update the fields that were specified in the active variables
   for (const auto & var : activeVars) {
-    idx_t levels(fieldSet[var.name()].shape(1));
-    auto UMatrixView = make_view<const double, 3>(spectralVerticalStatsSqrt[var.name()]);
-    auto spfView = make_view<double, 2>(fieldSet[var.name()]);
+    const auto UMatrixView = make_view<const double, 3>(spectralVerticalStatsSqrt[var.name()]);
+    ASSERT(UMatrixView.contiguous());
     const int nSpectralBinsFull = spectralVerticalStatsSqrt[var.name()].shape(0);
 
-    idx_t i = 0;
-    std::vector<double> col(levels), col2(levels);
-    for (idx_t jm1 = 0; jm1 < nb_zonal_wavenumbers; ++jm1) {
-      const idx_t m1 = zonal_wavenumbers(jm1);
-      for (std::size_t n1 = m1; n1 <= N; ++n1) {
-        // note that img stands for imaginary component are the
-        // odd indices in the first index of the spectral fields.
-        for (std::size_t img = 0; img < 2; ++img, ++i) {
-          for (idx_t jl = 0; jl < levels; ++jl) {
-            col[jl] = spfView(i, jl);
-          }
-          for (idx_t r = 0; r < levels; ++r) {
-            col2[r] = 0;
-            for (idx_t c = 0; c < levels; ++c) {
-              col2[r] += UMatrixView(n1, r, c) * col[c];
-            }
-          }
-          const double norm = std::sqrt(static_cast<double>((2 * n1 + 1) * nSpectralBinsFull));
-          for  (idx_t jl = 0; jl < levels; ++jl) {
-            spfView(i, jl) = col2[jl] / norm;
-          }
-        }
-      }
-    }
+    verticalConvolutionByWavenumber(specFunctionSpace, UMatrixView.data(), false,
+      [&](const std::size_t n1) {
+        return std::sqrt(static_cast<double>((2 * n1 + 1) * nSpectralBinsFull));},
+      fieldSet[var.name()]);
   }
 }
 
@@ -633,42 +662,19 @@ void spectralVerticalConvolutionSqrtAD(const oops::Variables & activeVars,
                                        const atlas::functionspace::Spectral & specFunctionSpace,
                                        const atlas::FieldSet & spectralVerticalStatsSqrt,
                                        atlas::FieldSet & fieldSet) {
-  const size_t N = specFunctionSpace.truncation();
-
-  const auto zonal_wavenumbers = specFunctionSpace.zonal_wavenumbers();
-  const idx_t nb_zonal_wavenumbers = zonal_wavenumbers.size();
+  util::Timer timer("saber::spectralb::specutils", "spectralVerticalConvolutionSqrtAD");
 
   // Only update the fields that were specified in the active variables
   for (const auto & var : activeVars) {
-    idx_t levels(fieldSet[var.name()].shape(1));
-    auto UMatrixView = make_view<const double, 3>(spectralVerticalStatsSqrt[var.name()]);
-    auto spfView = make_view<double, 2>(fieldSet[var.name()]);
+    const auto UMatrixView = make_view<const double, 3>(spectralVerticalStatsSqrt[var.name()]);
+    ASSERT(UMatrixView.contiguous());
     const int nSpectralBinsFull = spectralVerticalStatsSqrt[var.name()].shape(0);
 
-    idx_t i = 0;
-    std::vector<double> col(levels), col2(levels);
-    for (idx_t jm1 = 0; jm1 < nb_zonal_wavenumbers; ++jm1) {
-      const idx_t m1 = zonal_wavenumbers(jm1);
-      for (std::size_t n1 = m1; n1 <= N; ++n1) {
-        // note that img stands for imaginary component are the
-        // odd indices in the first index of the spectral fields.
-        for (std::size_t img = 0; img < 2; ++img, ++i) {
-          for (idx_t jl = 0; jl < levels; ++jl) {
-            col[jl] = spfView(i, jl);
-          }
-          for (idx_t r = 0; r < levels; ++r) {
-            col2[r] = 0;
-            for (idx_t c = 0; c < levels; ++c) {
-              col2[r] += UMatrixView(n1, c, r) * col[c];
-            }
-          }
-          const double norm = std::sqrt(static_cast<double>((2 * n1 + 1) * nSpectralBinsFull));
-          for  (idx_t jl = 0; jl < levels; ++jl) {
-            spfView(i, jl) = col2[jl] / norm;
-          }
-        }
-      }
-    }
+    // Transposed U matrix
+    verticalConvolutionByWavenumber(specFunctionSpace, UMatrixView.data(), true,
+      [&](const std::size_t n1) {
+        return std::sqrt(static_cast<double>((2 * n1 + 1) * nSpectralBinsFull));},
+      fieldSet[var.name()]);
   }
 }
 
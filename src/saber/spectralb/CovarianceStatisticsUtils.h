@@ -72,12 +72,15 @@ void spectralVerticalConvolution(const oops::Variables &,
                                  const atlas::FieldSet &,
                                  atlas::FieldSet &);
 
+/// Vertical convolution with the square-root (U) matrices of each total wavenumber
 void spectralVerticalConvolutionSqrt(const oops::Variables &,
                                      const atlas::functionspace::Spectral &,
                                      const atlas::FieldSet &,
                                      atlas::FieldSet &);
 
-
+/// Adjoint of spectralVerticalConvolutionSqrt. The transposed U matrices are applied with
+/// the transpose flag of the same GEMM, reading the matrices in place, so that the adjoint
+/// has the same memory access pattern and cost as the TL without a transposed copy.
 void spectralVerticalConvolutionSqrtAD(const oops::Variables &,
                                        const atlas::functionspace::Spectral &,
                                        const atlas::FieldSet &,
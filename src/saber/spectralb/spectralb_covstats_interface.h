@@ -42,6 +42,22 @@ void covSpectralUMatrix_f90(
   const int &,
   float &);
 
+// BLAS matrix-matrix product
+void dgemm_(
+  const char &,
+  const char &,
+  const int &,
+  const int &,
+  const int &,
+  const double &,
+  const double *,
+  const int &,
+  const double *,
+  const int &,
+  const double &,
+  double *,
+  const int &);
+
 }  // extern "C"
 // -----------------------------------------------------------------------------
 
@@ -0,0 +1,68 @@
+/*
+ * (C) Copyright 2024 Meteorologisk Institutt
+ *
+ * This software is licensed under the terms of the Apache Licence Version 2.0
+ * which can be obtained at http://www.apache.org/licenses/LICENSE-2.0.
+ */
+
+#include "saber/util/CounterBasedRandom.h"
+
+#include <cmath>
+
+namespace util {
+
+// -----------------------------------------------------------------------------
+
+std::array<std::uint32_t, 4> philox4x32(const std::array<std::uint32_t, 4> & counter,
+                                        const std::array<std::uint32_t, 2> & key) {
+  // Multipliers and Weyl sequence increments
+  const std::uint32_t m0 = 0xD2511F53;
+  const std::uint32_t m1 = 0xCD9E8D57;
+  const std::uint32_t w0 = 0x9E3779B9;
+  const std::uint32_t w1 = 0xBB67AE85;
+
+  std::array<std::uint32_t, 4> c = counter;
+  std::array<std::uint32_t, 2> k = key;
+  for (size_t jr = 0; jr < 10; ++jr) {
+    if (jr > 0) {
+      // Bump key
+      k[0] += w0;
+      k[1] += w1;
+    }
+
+    // Round
+    const std::uint64_t p0 = static_cast<std::uint64_t>(m0)*c[0];
+    const std::uint64_t p1 = static_cast<std::uint64_t>(m1)*c[2];
+    c = {static_cast<std::uint32_t>(p1 >> 32)^c[1]^k[0],
+         static_cast<std::uint32_t>(p1),
+         static_cast<std::uint32_t>(p0 >> 32)^c[3]^k[1],
+         static_cast<std::uint32_t>(p0)};
+  }
+  return c;
+}
+
+// -----------------------------------------------------------------------------
+
+double counterBasedNormal(const std::uint64_t & seed,
+                          const std::uint64_t & stream,
+                          const std::uint64_t & index) {
+  // Four 32-bit random words
+  const std::array<std::uint32_t, 4> r = philox4x32(
+    {static_cast<std::uint32_t>(index), static_cast<std::uint32_t>(index >> 32),
+     static_cast<std::uint32_t>(stream), static_cast<std::uint32_t>(stream >> 32)},
+    {static_cast<std::uint32_t>(seed), static_cast<std::uint32_t>(seed >> 32)});
+
+  // Two uniform numbers with 53-bit resolution, u1 in (0,1] and u2 in [0,1)
+  const double scale = 1.0/9007199254740992.0;
+  const std::uint64_t r01 = (static_cast<std::uint64_t>(r[0]) << 21)^(r[1] >> 11);
+  const std::uint64_t r23 = (static_cast<std::uint64_t>(r[2]) << 21)^(r[3] >> 11);
+  const double u1 = (static_cast<double>(r01 & 0x1FFFFFFFFFFFFF)+1.0)*scale;
+  const double u2 = static_cast<double>(r23 & 0x1FFFFFFFFFFFFF)*scale;
+
+  // Box-Muller transform
+  return std::sqrt(-2.0*std::log(u1))*std::cos(2.0*M_PI*u2);
+}
+
+// -----------------------------------------------------------------------------
+
+}  // namespace util
@@ -0,0 +1,27 @@
+/*
+ * (C) Copyright 2024 Meteorologisk Institutt
+ *
+ * This software is licensed under the terms of the Apache Licence Version 2.0
+ * which can be obtained at http://www.apache.org/licenses/LICENSE-2.0.
+ */
+
+#pragma once
+
+#include <array>
+#include <cstdint>
+
+namespace util {
+
+/// Philox4x32-10 counter-based generator (Salmon et al., 2011): the output only depends on the
+/// counter and on the key, so that any element of a random sequence can be generated
+/// independently of the others.
+std::array<std::uint32_t, 4> philox4x32(const std::array<std::uint32_t, 4> &,
+                                        const std::array<std::uint32_t, 2> &);
+
+/// Standard normal random number attached to an index of a stream, for a given seed. The value
+/// does not depend on the order in which indices are visited, nor on the MPI task generating it.
+double counterBasedNormal(const std::uint64_t & seed,
+                          const std::uint64_t & stream,
+                          const std::uint64_t & index);
+
+}  // namespace util